@@ -0,0 +1,189 @@
+// Row-hammer susceptibility tester for HM511000
+// Hammers the two rows either side of a victim with back-to-back RAS-only
+// cycles from inline assembly, then counts flipped bits in the victim row.
+// Each run is repeated without hammering for the same time, so retention
+// loss is reported separately from disturb errors.
+
+#include "dram_core.h"
+
+// Victim rows to characterize; edges of the array and of the top-bit half
+const uint16_t victimRows[] = {
+  1, 2, rowCount / 4 - 1, rowCount / 2 - 1, rowCount / 2, rowCount * 3 / 4, rowCount - 2
+};
+const uint8_t victimCount = sizeof(victimRows) / sizeof(victimRows[0]);
+
+// Activations per aggressor row for each measurement point
+const uint32_t hammerCounts[] = {1000UL, 10000UL, 100000UL, 1000000UL};
+const uint8_t hammerCountSteps = sizeof(hammerCounts) / sizeof(hammerCounts[0]);
+
+// Pairs per interrupt-free burst. One burst is ~0.9 ms, shorter than a
+// Timer0 overflow, so millis() does not drop ticks while hammering.
+const uint16_t HAMMER_BURST = 1024;
+// Bursts between refreshes, keeping the rest of the array inside half the
+// refresh period (4 for an 8 ms part)
+const uint8_t BURSTS_PER_REFRESH = refreshPeriodMicros / 2000;
+
+void dramWrite(uint16_t row, uint16_t col, bool val) {
+  dqOutput(val);
+
+  setAddress(row); rasLow();
+  asm volatile ("nop\n\t""nop\n\t"::);
+
+  setAddress(col); casLow();
+  asm volatile ("nop\n\t"::);
+
+  weLow();
+  asm volatile ("nop\n\t""nop\n\t"::);
+  weHigh();
+
+  casHigh(); rasHigh();
+}
+
+bool dramRead(uint16_t row, uint16_t col) {
+  dqInput();
+
+  setAddress(row); rasLow();
+  asm volatile ("nop\n\t""nop\n\t"::);
+
+  setAddress(col); casLow();
+  asm volatile ("nop\n\t""nop\n\t""nop\n\t"::);
+
+  bool val = dqRead();
+
+  casHigh(); rasHigh();
+  return val;
+}
+
+// Rows sharing the refresh address bits refresh together, so the victim's
+// twins in the other half are skipped with it
+void refreshAllRowsExcept(uint16_t skipRow) {
+  for (uint16_t row = 0; row < chip.refreshRows; row++) {
+    if (row == skipRow % chip.refreshRows) continue;
+    setAddress(row);
+    rasLow();
+    asm volatile ("nop\n\t""nop\n\t"::);
+    rasHigh();
+  }
+}
+
+// Alternating RAS-only activations of two rows, 14 cycles per pair:
+// RAS is low for 2 cycles (125 ns > tRAS) and high for at least 3
+// (187 ns > tRP). The address ports are written as whole bytes from
+// images precomputed by the caller.
+void hammerPair(uint16_t rowA, uint16_t rowB, uint16_t pairs) {
+  if (pairs == 0) return;
+
+  uint8_t dA = addressPortD(rowA);
+  uint8_t bA = addressPortB(rowA);
+  uint8_t dB = addressPortD(rowB);
+  uint8_t bB = addressPortB(rowB);
+  uint8_t cHigh = PORTC | (1 << RAS_BIT);
+  uint8_t cLow = cHigh & ~(1 << RAS_BIT);
+
+  cli();
+  asm volatile (
+    "1:\n\t"
+    "out %[pd], %[dA]\n\t"
+    "out %[pb], %[bA]\n\t"
+    "out %[pc], %[lo]\n\t"
+    "nop\n\t"
+    "out %[pc], %[hi]\n\t"
+    "out %[pd], %[dB]\n\t"
+    "out %[pb], %[bB]\n\t"
+    "out %[pc], %[lo]\n\t"
+    "nop\n\t"
+    "out %[pc], %[hi]\n\t"
+    "sbiw %[n], 1\n\t"
+    "brne 1b\n\t"
+    : [n] "+w" (pairs)
+    : [pd] "I" (_SFR_IO_ADDR(PORTD)),
+      [pb] "I" (_SFR_IO_ADDR(PORTB)),
+      [pc] "I" (_SFR_IO_ADDR(PORTC)),
+      [dA] "r" (dA), [bA] "r" (bA),
+      [dB] "r" (dB), [bB] "r" (bB),
+      [lo] "r" (cLow), [hi] "r" (cHigh)
+  );
+  sei();
+}
+
+// Victim row holds 1s, aggressors hold 0s: the worst case for charge
+// leaking toward the neighbouring word lines.
+void fillNeighbourhood(uint16_t victim) {
+  for (uint16_t col = 0; col < colCount; col++) {
+    dramWrite(victim - 1, col, 0);
+    dramWrite(victim, col, 1);
+    dramWrite(victim + 1, col, 0);
+  }
+}
+
+uint16_t countVictimErrors(uint16_t victim) {
+  uint16_t errors = 0;
+  for (uint16_t col = 0; col < colCount; col++)
+    if (dramRead(victim, col) != 1) errors++;
+  return errors;
+}
+
+// Runs `activations` double-sided hammer pairs around victim (or just waits
+// as long when hammer is false) while keeping every other row refreshed.
+unsigned long stressVictim(uint16_t victim, uint32_t activations, bool hammer, unsigned long holdMillis) {
+  unsigned long t0 = millis();
+  uint8_t bursts = 0;
+
+  if (hammer) {
+    while (activations > 0) {
+      uint16_t pairs = activations > HAMMER_BURST ? HAMMER_BURST : activations;
+      hammerPair(victim - 1, victim + 1, pairs);
+      activations -= pairs;
+      if (++bursts == BURSTS_PER_REFRESH) {
+        refreshAllRowsExcept(victim);
+        bursts = 0;
+      }
+    }
+  } else {
+    while (millis() - t0 < holdMillis) {
+      delayMicroseconds(3600);
+      refreshAllRowsExcept(victim);
+    }
+  }
+
+  return millis() - t0;
+}
+
+void hammerVictim(uint16_t victim) {
+  Serial.print(F("Victim row "));
+  Serial.println(victim);
+
+  for (uint8_t step = 0; step < hammerCountSteps; step++) {
+    fillNeighbourhood(victim);
+    unsigned long elapsed = stressVictim(victim, hammerCounts[step], true, 0);
+    uint16_t disturbErrors = countVictimErrors(victim);
+
+    fillNeighbourhood(victim);
+    stressVictim(victim, 0, false, elapsed);
+    uint16_t retentionErrors = countVictimErrors(victim);
+
+    Serial.print(F("  activations="));
+    Serial.print(hammerCounts[step]);
+    Serial.print(F(" time="));
+    Serial.print(elapsed);
+    Serial.print(F("ms disturb="));
+    Serial.print(disturbErrors);
+    Serial.print(F(" retention-only="));
+    Serial.println(retentionErrors);
+  }
+}
+
+void setup() {
+  Serial.begin(LINK_BAUD);
+
+  setupPins();
+
+  Serial.println(F("=== Row-Hammer Susceptibility Test ==="));
+
+  for (uint8_t v = 0; v < victimCount; v++)
+    hammerVictim(victimRows[v]);
+
+  Serial.println(F("Hammer test complete."));
+}
+
+void loop() {}
@@ -1,101 +1,163 @@
 // DRAM I/O Latency Tester for HM511000 using Port Manipulation (Arduino Uno)
 
-#define DQ_BIT     0      // A0 = PC0
-#define RAS_BIT    1      // A1 = PC1
-#define CAS_BIT    2      // A2 = PC2
-#define WE_BIT     3      // A3 = PC3
-
-#define ADDR_LOW_PORT PORTD // D0-D7 = A0-A7
-#define ADDR_HIGH_PORT PORTB // D10 = PB2 = A8, D11 = PB3 = A9
-
-#define DQ_IN()  (DDRC &= ~(1 << DQ_BIT))         // Input mode
-#define DQ_OUT() (DDRC |=  (1 << DQ_BIT))         // Output mode
-#define DQ_READ() ((PINC >> DQ_BIT) & 0x01)
-#define DQ_WRITE(x) ((x) ? (PORTC |= (1 << DQ_BIT)) : (PORTC &= ~(1 << DQ_BIT)))
-
-void setAddress(uint16_t addr) {
-  ADDR_LOW_PORT = addr & 0xFF;
-  if (addr & 0x0100) PORTB |= (1 << 2); else PORTB &= ~(1 << 2); // A8 = PB2
-  if (addr & 0x0200) PORTB |= (1 << 3); else PORTB &= ~(1 << 3); // A9 = PB3
-}
-
-void dramWriteBit(uint16_t addr, bool value, uint16_t wePulseMicros) {
-  DQ_OUT();
-  DQ_WRITE(value);
+// A0–A7 on PORTD, A8/A9 on PB2/PB3, leaving PB0 for ICP1
+#define DRAM_WIRING DRAM_WIRING_PORTD
+#include "dram_core.h"
 
-  uint8_t row = (addr >> 8) & 0xFF;
-  uint8_t col = addr & 0xFF;
+// Write cycle with an adjustable WE pulse; the core's writeBit() has a
+// fixed 1 µs one
+void dramWriteBit(uint32_t addr, bool value, uint16_t wePulseMicros) {
+  dqOutput(value);
 
-  setAddress(row);
-  PORTC &= ~(1 << RAS_BIT); // RAS low
+  setAddress(rowOf(addr));
+  rasLow();
   delayMicroseconds(1);
 
-  setAddress(col);
-  PORTC &= ~(1 << CAS_BIT); // CAS low
+  setAddress(colOf(addr));
+  casLow();
   delayMicroseconds(1);
 
-  PORTC &= ~(1 << WE_BIT);  // WE low
+  weLow();
   delayMicroseconds(wePulseMicros);
-  PORTC |= (1 << WE_BIT);   // WE high
+  weHigh();
 
-  PORTC |= (1 << CAS_BIT);  // CAS high
-  PORTC |= (1 << RAS_BIT);  // RAS high
+  casHigh();
+  rasHigh();
 }
 
-bool dramReadBit(uint16_t addr) {
-  DQ_IN();
+// Access time is captured by Timer1 running at 16 MHz (62.5 ns per tick).
+// DQ is jumpered to ICP1 (D8 = PB0, unused by this wiring) in addition to A0,
+// and the timer is started in the instruction right after CAS falls, so
+// ICR1 holds the CAS-to-data time in CPU cycles plus a fixed offset.
+#define ICP_BIT 0 // PB0 = D8
+
+// cbi→sts start skew plus the 2-cycle ICP synchronizer. Calibrate by
+// tying D8 to the CAS line with the edge flipped and reading the result.
+const uint8_t captureOffsetCycles = 3;
+const uint16_t captureTimeoutCycles = 1600; // 100 µs
+const uint16_t LATENCY_TIMEOUT = 0xFFFF;
+
+void setupLatencyTimer() {
+  DDRB &= ~(1 << ICP_BIT);
+  PORTB &= ~(1 << ICP_BIT);
+  TIMSK1 = 0;                 // polled, no interrupts
+  TCCR1A = 0;                 // normal mode, undo the core's PWM setup
+  TCCR1B = (1 << ICES1);      // rising edge, clock stopped
+}
 
-  uint8_t row = (addr >> 8) & 0xFF;
-  uint8_t col = addr & 0xFF;
+// Returns CAS-to-DQ rise time in 62.5 ns cycles, or LATENCY_TIMEOUT.
+// DQ is driven low first and released, so a stored 1 gives a clean edge.
+uint16_t measureReadLatency(uint32_t addr) {
+  uint8_t startTimer = (1 << ICES1) | (1 << CS10);
 
-  setAddress(row);
-  PORTC &= ~(1 << RAS_BIT);
-  delayMicroseconds(1);
+  dqOutput(0);
+  dqInput();
 
-  setAddress(col);
-  PORTC &= ~(1 << CAS_BIT);
+  setAddress(rowOf(addr));
+  rasLow();
   delayMicroseconds(1);
+  setAddress(colOf(addr));
+
+  uint8_t oldSREG = SREG;
+  cli();
+  TCCR1B = (1 << ICES1);
+  TCNT1 = 0;
+  TIFR1 = (1 << ICF1);
+
+  asm volatile (
+    "cbi %[pc], %[cas]\n\t"
+    "sts %[tccr], %[start]\n\t"
+    :
+    : [pc] "I" (_SFR_IO_ADDR(PORTC)), [cas] "I" (CAS_BIT),
+      [tccr] "n" (_SFR_MEM_ADDR(TCCR1B)), [start] "r" (startTimer)
+  );
+
+  uint16_t latency = LATENCY_TIMEOUT;
+  while (TCNT1 < captureTimeoutCycles) {
+    if (TIFR1 & (1 << ICF1)) {
+      uint16_t captured = ICR1;
+      latency = captured > captureOffsetCycles ? captured - captureOffsetCycles : 0;
+      break;
+    }
+  }
 
-  bool val = DQ_READ();
+  TCCR1B = (1 << ICES1);
+  SREG = oldSREG;
 
-  PORTC |= (1 << CAS_BIT);
-  PORTC |= (1 << RAS_BIT);
-  return val;
+  casHigh();
+  rasHigh();
+  return latency;
 }
 
-unsigned long measureReadLatency(uint16_t addr, bool expectedBit) {
-  DQ_IN();
+// Latency distribution over the whole chip, one bucket per 62.5 ns cycle
+const uint8_t LATENCY_BUCKETS = 32;
+uint32_t latencyHistogram[LATENCY_BUCKETS];
+uint32_t latencyOverflow = 0; // beyond the last bucket but captured
+uint32_t latencyTimeouts = 0; // no edge: cell did not read back 1
 
-  uint8_t row = (addr >> 8) & 0xFF;
-  uint8_t col = addr & 0xFF;
-
-  setAddress(row);
-  PORTC &= ~(1 << RAS_BIT);
-  delayMicroseconds(1);
+void printCycles(uint8_t cycles) {
+  Serial.print(cycles * 625UL / 10);
+  Serial.print(" ns");
+}
 
-  setAddress(col);
-  unsigned long t0 = micros();
-  PORTC &= ~(1 << CAS_BIT);  // CAS low
+// Runs with Serial down: A0/A1 are on the USART pins
+void buildLatencyHistogram() {
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) latencyHistogram[i] = 0;
+  latencyOverflow = 0;
+  latencyTimeouts = 0;
+
+  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
+    dramWriteBit(addr, 1, 1);
+    uint16_t latency = measureReadLatency(addr);
+    if (latency == LATENCY_TIMEOUT) latencyTimeouts++;
+    else if (latency >= LATENCY_BUCKETS) latencyOverflow++;
+    else latencyHistogram[latency]++;
+  }
+}
 
-  unsigned long tLatency = 9999;
-  unsigned long timeout = 100;
-  while ((micros() - t0) < timeout) {
-    if (DQ_READ() == expectedBit) {
-      tLatency = micros() - t0;
-      break;
+void printLatencyHistogram() {
+  Serial.println("Read latency histogram (CAS to DQ):");
+  uint32_t seen = 0;
+  uint32_t captured = totalAddresses - latencyTimeouts;
+  bool medianShown = false, p99Shown = false;
+  uint8_t slowest = 0;
+
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    if (!latencyHistogram[i]) continue;
+    slowest = i;
+    Serial.print("  ");
+    printCycles(i);
+    Serial.print(": ");
+    Serial.println(latencyHistogram[i]);
+
+    seen += latencyHistogram[i];
+    if (!medianShown && seen * 2 >= captured) {
+      Serial.print("    ^ median ");
+      printCycles(i);
+      Serial.println();
+      medianShown = true;
+    }
+    if (!p99Shown && seen * 100 >= captured * 99) {
+      Serial.print("    ^ p99 ");
+      printCycles(i);
+      Serial.println();
+      p99Shown = true;
     }
   }
 
-  PORTC |= (1 << CAS_BIT);
-  PORTC |= (1 << RAS_BIT);
-  return tLatency;
+  Serial.print("  slowest bucket ");
+  printCycles(slowest);
+  Serial.print(", overflow ");
+  Serial.print(latencyOverflow);
+  Serial.print(", timeouts ");
+  Serial.println(latencyTimeouts);
 }
 
-unsigned long findMinWorkingWritePulse(uint16_t addr, bool value) {
+unsigned long findMinWorkingWritePulse(uint32_t addr, bool value) {
   for (uint16_t pulse = 10; pulse >= 1; pulse--) {
     dramWriteBit(addr, value, pulse);
     delayMicroseconds(5);
-    bool result = dramReadBit(addr);
+    bool result = readBit(addr);
     if (result == value) {
       return pulse;
     }
@@ -104,35 +166,40 @@ unsigned long findMinWorkingWritePulse(uint16_t addr, bool value) {
 }
 
 void setup() {
-  Serial.begin(115200);
+  setupPins();
+  setupLatencyTimer();
+
+  Serial.begin(LINK_BAUD);
   delay(1000);
   Serial.println("=== DRAM Latency Test ===");
+  Serial.end(); // give A0/A1 back to PORTD until the results are in
 
-  // Configure pins
-  DDRC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT); // RAS, CAS, WE
-  PORTC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT); // set high
-
-  DDRD = 0xFF;  // A0-A7 outputs (PORTD)
-  DDRB |= (1 << 2) | (1 << 3); // A8, A9 = PB2, PB3
-
-  DDRC |= (1 << DQ_BIT); // DQ = output by default
-
-  const uint16_t testAddr = 0x123; // Any address
+  const uint32_t testAddr = 0x123; // Any address
 
   // First, write known bit
   dramWriteBit(testAddr, 1, 5);
   delayMicroseconds(5);
 
-  unsigned long readLatency = measureReadLatency(testAddr, 1);
-  Serial.print("Read latency: ");
-  Serial.print(readLatency);
-  Serial.println(" µs");
+  uint16_t readLatency = measureReadLatency(testAddr);
 
   // Find shortest successful WE pulse
   unsigned long minWrite = findMinWorkingWritePulse(testAddr, 1);
+
+  buildLatencyHistogram();
+
+  Serial.begin(LINK_BAUD);
+  Serial.print("Read latency: ");
+  if (readLatency == LATENCY_TIMEOUT) Serial.println("timeout");
+  else {
+    printCycles(readLatency);
+    Serial.println();
+  }
+
   Serial.print("Minimum successful write pulse: ");
   Serial.print(minWrite);
   Serial.println(" µs");
+
+  printLatencyHistogram();
 }
 
 void loop() {}
@@ -1,92 +1,111 @@
-// Define refresh constants
-const unsigned long totalAddresses = 131072UL;
-const unsigned long refreshInterval = 250; // µs
-unsigned long lastRefreshMicros = 0;
+// Full HM511000 test with port manipulation and latency statistics:
+// address pre-screen, fixed patterns, LFSR, March C-, neighbourhood tests
+// and an access-time map, checkpointed to EEPROM; also batch and soak modes.
+// Read-modify-write passes take one RAS/CAS cycle per cell only with
+// DQ_DOUT_RESISTOR 1, which needs the ~330 Ω resistor on Dout fitted
+// first (see dram_core.h); define it above the includes.
 
-// RAS, CAS, WE on PORTC
-#define RAS_BIT 1
-#define CAS_BIT 2
-#define WE_BIT  3
-#define DQ_BIT  0
+#include <EEPROM.h>
+#include <string.h>
 
-// A0–A7 on PORTD (pins 2–9), A8–A9 on PORTB (pins 10–11)
-inline void setAddress(uint16_t addr) {
-  // PORTD: lower 8 bits (A0–A7)
-  PORTD = (PORTD & 0x03) | ((addr << 2) & 0xFC); // bits 2–7
-  PORTD = (PORTD & 0xFC) | ((addr >> 6) & 0x03); // bits 0–1 from bits 8–9
+#define STATUS_SIZE 8 // no status records; keep the RAM for the TX ring
+#include "dram_core.h"
 
-  // PORTB: bits 2–3 hold A8–A9
-  PORTB = (PORTB & 0xF3) | ((addr >> 6) & 0x0C); // bits 2–3 = addr[8,9]
-}
-
-void refreshAllRows() {
-  for (uint16_t row = 0; row < 256; row++) {
-    setAddress(row);
-    PORTC &= ~(1 << RAS_BIT); // RAS low
-    delayMicroseconds(1);
-    PORTC |= (1 << RAS_BIT);  // RAS high
-  }
-}
-
-void refreshIfNeeded() {
-  unsigned long now = micros();
-  if (now - lastRefreshMicros >= refreshInterval) {
-    refreshAllRows();
-    lastRefreshMicros = now;
+// Address-line pre-screen. The low colBits address bits go out as the
+// column and the rest as the row, so each bit maps to one physical A-line
+// in one of the two phases.
+void printAddressLine(uint8_t bit) {
+  if (bit < colBits) {
+    Serial.print(F("col A"));
+    Serial.print(bit);
+  } else {
+    Serial.print(F("row A"));
+    Serial.print(bit - colBits);
   }
 }
 
-unsigned long writeBitTimed(uint32_t addr, bool value) {
-  refreshIfNeeded();
-  uint16_t row = (addr >> 8) & 0x1FF;
-  uint16_t col = addr & 0xFF;
+// Walks a single flipped bit away from base. Every neighbour base^(1<<i)
+// holds `pattern`; writing the inverse to one cell must not show up at base
+// or at any other neighbour, otherwise that line is stuck, open or shorted
+// to another one. Costs two writes plus one read per other line per bit.
+uint8_t walkAddressBits(uint32_t base, bool pattern) {
+  uint8_t faults = 0;
 
-  DDRC |= (1 << DQ_BIT);               // DQ output
-  bitWrite(PORTC, DQ_BIT, value);      // Write bit
+  writeBit(base, pattern);
+  for (uint8_t i = 0; i < addressBits; i++)
+    writeBit(base ^ (1UL << i), pattern);
 
-  unsigned long t0 = micros();
+  // Inverse at base must stay at base (catches lines stuck at the base level)
+  writeBit(base, !pattern);
+  for (uint8_t i = 0; i < addressBits; i++) {
+    if (readBit(base ^ (1UL << i)) != pattern) {
+      Serial.print(F("  "));
+      printAddressLine(i);
+      Serial.println(pattern ? F(" stuck high") : F(" stuck low"));
+      faults++;
+    }
+  }
+  writeBit(base, pattern);
 
-  setAddress(row);
-  PORTC &= ~(1 << RAS_BIT);            // RAS low
-  delayMicroseconds(1);
+  for (uint8_t i = 0; i < addressBits; i++) {
+    uint32_t probe = base ^ (1UL << i);
+    writeBit(probe, !pattern);
 
-  setAddress(col);
-  PORTC &= ~(1 << CAS_BIT);            // CAS low
-  delayMicroseconds(1);
+    if (readBit(base) != pattern) {
+      Serial.print(F("  "));
+      printAddressLine(i);
+      Serial.println(F(" open or stuck"));
+      faults++;
+    }
 
-  PORTC &= ~(1 << WE_BIT);             // WE low
-  delayMicroseconds(1);
+    for (uint8_t j = 0; j < addressBits; j++) {
+      if (j == i) continue;
+      if (readBit(base ^ (1UL << j)) != pattern) {
+        Serial.print(F("  "));
+        printAddressLine(i);
+        Serial.print(F(" shorted to "));
+        printAddressLine(j);
+        Serial.println();
+        faults++;
+      }
+    }
 
-  PORTC |= (1 << WE_BIT);              // WE high
-  PORTC |= (1 << CAS_BIT);             // CAS high
-  PORTC |= (1 << RAS_BIT);             // RAS high
+    writeBit(probe, pattern);
+  }
 
-  unsigned long t1 = micros();
-  return t1 - t0;
+  return faults;
 }
 
-unsigned long readBitTimed(uint32_t addr, bool &result) {
-  refreshIfNeeded();
-  uint16_t row = (addr >> 8) & 0x1FF;
-  uint16_t col = addr & 0xFF;
+// Milliseconds-long screen run before the full-array passes. Returns the
+// number of faults found; anything non-zero means the chip is not worth a
+// full pattern run.
+uint8_t addressPrescreen() {
+  Serial.println(F("Address prescreen"));
 
-  DDRC &= ~(1 << DQ_BIT); // DQ input
-  PORTC &= ~(1 << RAS_BIT);
-  setAddress(row);
-  delayMicroseconds(1);
+  // A chip that cannot hold both levels at one cell fails everything else
+  writeBit(0, 0);
+  bool low = readBit(0);
+  writeBit(0, 1);
+  bool high = readBit(0);
+  if (low != 0 || high != 1) {
+    Serial.println(F("  DQ dead or stuck"));
+    return 1;
+  }
 
-  setAddress(col);
-  PORTC &= ~(1 << CAS_BIT);
-  delayMicroseconds(1);
+  uint8_t faults = walkAddressBits(0, 0);                      // walking ones
+  faults += walkAddressBits(totalAddresses - 1, 1);            // walking zeros
 
-  unsigned long t0 = micros();
-  result = bitRead(PINC, DQ_BIT);
-  unsigned long t1 = micros();
+  Serial.println(faults ? F("Prescreen FAILED") : F("Prescreen passed"));
+  return faults;
+}
 
-  PORTC |= (1 << CAS_BIT);
-  PORTC |= (1 << RAS_BIT);
+// Cycle-time statistics with a coarse histogram for percentiles
+const uint8_t LATENCY_BUCKETS = 16;
+const uint8_t LATENCY_BUCKET_SHIFT = 3; // 8 cycles = 500 ns per bucket
 
-  return t1 - t0;
+void printNanos(unsigned long cycles) {
+  Serial.print(cycles * 625UL / 10);
+  Serial.print(F("ns"));
 }
 
 struct LatencyStats {
@@ -94,99 +113,1131 @@ struct LatencyStats {
   unsigned long max = 0;
   unsigned long total = 0;
   uint32_t count = 0;
+  uint32_t buckets[LATENCY_BUCKETS] = {0};
 
   void add(unsigned long t) {
     if (t < min) min = t;
     if (t > max) max = t;
     total += t;
     count++;
+    unsigned long b = t >> LATENCY_BUCKET_SHIFT;
+    buckets[b < LATENCY_BUCKETS ? b : LATENCY_BUCKETS - 1]++;
+  }
+
+  // Upper edge of the bucket holding the given percentile, in cycles
+  unsigned long percentile(uint8_t pct) {
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) {
+      seen += buckets[b];
+      if (seen * 100 >= count * pct) return (unsigned long)(b + 1) << LATENCY_BUCKET_SHIFT;
+    }
+    return max;
   }
 
   void print(const char *label) {
     Serial.print(label);
-    Serial.print(": min=");
-    Serial.print(min);
-    Serial.print("µs max=");
-    Serial.print(max);
-    Serial.print("µs avg=");
-    Serial.print(count ? (total / count) : 0);
-    Serial.println("µs");
+    Serial.print(F(": min="));
+    printNanos(min);
+    Serial.print(F(" max="));
+    printNanos(max);
+    Serial.print(F(" avg="));
+    printNanos(count ? (total / count) : 0);
+    Serial.print(F(" p50<="));
+    printNanos(percentile(50));
+    Serial.print(F(" p99<="));
+    printNanos(percentile(99));
+    Serial.println();
   }
 };
 
-bool patternBit(uint8_t patternID, uint32_t addr) {
-  switch (patternID) {
-    case 0: return 0;
-    case 1: return 1;
-    case 2: return addr & 1;
-    case 3: return (addr >> 1) & 1;
-    case 4: return (addr >> 8) & 1;
-    case 5: return addr & 0xFFFF & 1;
-    case 6: return (~addr) & 1;
-    default: return 0;
+// Run state mirrored to EEPROM so a long run survives a reset or brownout.
+// It is saved at step boundaries only: DRAM contents do not survive a
+// reset, so a resumed run restarts the interrupted step from its write
+// phase and a mid-step save would only wear the EEPROM.
+struct Checkpoint {
+  uint16_t magic;
+  uint8_t step;
+  uint8_t resumes;
+  uint32_t errors;      // errors across the whole run
+  uint32_t stepErrors;  // errors when the current step started
+  uint32_t firstFail;   // first failing address of the run
+  uint16_t failedSteps; // bit n = step n saw errors
+  uint16_t lfsrSeed;
+};
+
+const uint16_t CHECKPOINT_MAGIC = 0x5D1A; // bump when the layout or steps change
+const int CHECKPOINT_EEPROM_ADDR = 0;
+
+// Stop the run once this many errors are seen; 0 never aborts
+const uint32_t abortErrorThreshold = 1000;
+
+Checkpoint checkpoint;
+
+void saveCheckpoint() {
+  // Each changed byte takes ~3.3 ms to program and the next write waits
+  // for it, so refresh before every byte rather than around the whole
+  // record: a few changed bytes back to back would overrun the refresh
+  // window.
+  const uint8_t *bytes = (const uint8_t *)&checkpoint;
+  for (uint8_t i = 0; i < sizeof(checkpoint); i++) {
+    if (EEPROM.read(CHECKPOINT_EEPROM_ADDR + i) == bytes[i]) continue;
+    refreshAllRows();
+    EEPROM.write(CHECKPOINT_EEPROM_ADDR + i, bytes[i]);
   }
+  refreshAllRows();
+  lastRefreshMicros = micros();
 }
 
-void runPatternWithLatency(uint8_t patternID) {
-  Serial.print("Pattern ");
-  Serial.println(patternID);
+bool abortRequested() {
+  return abortErrorThreshold && checkpoint.errors >= abortErrorThreshold;
+}
 
-  LatencyStats writeStats, readStats;
+// 4-bit counters, two per byte. The access-time map keeps its worst tCAC
+// per column here and soak mode its error count per row; the two never run
+// in the same session, so on the Uno they share the RAM.
+const uint16_t NIBBLE_SLOTS = colCount > rowCount ? colCount : rowCount;
+uint8_t nibbles[NIBBLE_SLOTS / 2];
+
+uint8_t nibbleAt(uint16_t i) {
+  return (nibbles[i >> 1] >> ((i & 1) << 2)) & 0x0F;
+}
+
+void setNibble(uint16_t i, uint8_t v) {
+  uint8_t shift = (i & 1) << 2;
+  nibbles[i >> 1] = (nibbles[i >> 1] & ~(0x0F << shift)) | (v << shift);
+}
+
+// Failure stream. Errors are gathered into a bitmap of the failing columns
+// of the current row and sent when the row changes, as column runs:
+//   FR <row> <col>[-<col>][,...][/<period>] <L|H|M>   e.g. "FR 12 0-1023 L"
+//   FR <row>[-<row>] =                                same map as the row before
+// A map that repeats every 2^n columns, as address-line faults leave, is
+// sent as its first period followed by /period. L/H/M is what the failing
+// cells read back: low, high or mixed. A dead row costs one line per pass
+// and a dead column two, instead of one per cell.
+const uint16_t NO_ROW = 0xFFFF;
+const uint8_t FAIL_LOW = 1;
+const uint8_t FAIL_HIGH = 2;
+
+uint8_t failMap[colCount / 8];
+uint8_t prevFailMap[colCount / 8];
+uint16_t failRow = NO_ROW;
+uint8_t failLevels = 0;
+uint16_t prevFailRow = NO_ROW;  // last row sent or folded into a repeat
+uint8_t prevFailLevels = 0;
+uint16_t repeatFirst = NO_ROW;  // start of a pending "=" span
+
+inline bool failBit(uint16_t col) {
+  return (failMap[col >> 3] >> (col & 7)) & 1;
+}
+
+// Smallest power-of-two column period of the map, or colCount
+uint16_t failPeriod() {
+  if (memcmp(failMap + 1, failMap, sizeof(failMap) - 1) == 0) {
+    uint8_t b = failMap[0];
+    if (b == 0xFF) return colCount; // solid row reads best as one run
+    for (uint8_t p = 2; p < 8; p <<= 1)
+      if ((uint8_t)((b >> p) | (b << (8 - p))) == b) return p;
+    return 8;
+  }
+  for (uint16_t bytes = 2; bytes < sizeof(failMap); bytes <<= 1) {
+    if (memcmp(failMap + bytes, failMap, sizeof(failMap) - bytes) == 0) return bytes * 8;
+  }
+  return colCount;
+}
+
+void sendFailRow() {
+  Serial.print(F("FR "));
+  Serial.print(failRow);
+  uint16_t span = failPeriod();
+  char sep = ' ';
+  for (uint16_t col = 0; col < span; col++) {
+    if ((col & 7) == 0 && !failMap[col >> 3]) {
+      col += 7;
+      continue;
+    }
+    if (!failBit(col)) continue;
+    uint16_t end = col;
+    while (end + 1 < span && failBit(end + 1)) end++;
+    Serial.print(sep);
+    Serial.print(col);
+    if (end != col) {
+      Serial.print('-');
+      Serial.print(end);
+    }
+    sep = ',';
+    col = end;
+  }
+  if (span < colCount) {
+    Serial.print('/');
+    Serial.print(span);
+  }
+  Serial.print(' ');
+  Serial.println(failLevels == FAIL_LOW ? 'L' : failLevels == FAIL_HIGH ? 'H' : 'M');
+}
+
+void sendRepeats() {
+  if (repeatFirst == NO_ROW) return;
+  Serial.print(F("FR "));
+  Serial.print(repeatFirst);
+  if (prevFailRow != repeatFirst) {
+    Serial.print('-');
+    Serial.print(prevFailRow);
+  }
+  Serial.println(F(" ="));
+  repeatFirst = NO_ROW;
+}
+
+void flushFailRow() {
+  if (failRow == NO_ROW) return;
+
+  // Passes walk rows in either direction; a repeat must be a neighbour
+  bool adjacent = prevFailRow != NO_ROW && (failRow == prevFailRow + 1 || failRow + 1 == prevFailRow);
+  if (adjacent && failLevels == prevFailLevels && !memcmp(failMap, prevFailMap, sizeof(failMap))) {
+    if (repeatFirst == NO_ROW) repeatFirst = failRow;
+  } else {
+    sendRepeats();
+    sendFailRow();
+    memcpy(prevFailMap, failMap, sizeof(failMap));
+    prevFailLevels = failLevels;
+  }
+  prevFailRow = failRow;
+
+  memset(failMap, 0, sizeof(failMap));
+  failRow = NO_ROW;
+  failLevels = 0;
+}
+
+// Ends a pass: the next one starts a fresh run of rows
+void flushFailures() {
+  flushFailRow();
+  sendRepeats();
+  prevFailRow = NO_ROW;
+}
+
+// Soak mode keeps a saturating error count per row in the nibbles
+bool countRowErrors = false;
+
+void reportError(uint32_t addr, bool actual) {
+  if (checkpoint.errors == 0) checkpoint.firstFail = addr;
+  checkpoint.errors++;
+
+  uint16_t row = rowOf(addr);
+  if (countRowErrors && nibbleAt(row) < 15) setNibble(row, nibbleAt(row) + 1);
+  if (row != failRow) {
+    flushFailRow();
+    failRow = row;
+  }
+  uint16_t col = colOf(addr);
+  failMap[col >> 3] |= 1 << (col & 7);
+  failLevels |= actual ? FAIL_HIGH : FAIL_LOW;
+}
 
+// Pseudo-random data from a 16-bit Fibonacci LFSR (x^16+x^14+x^13+x^11+1).
+// Nothing is stored: the read pass reseeds and regenerates the expected
+// stream. The taps all sit below bit 8, so the next 8 feedback bits depend
+// only on the current state and one step advances the register a whole byte.
+struct LfsrPattern {
+  uint16_t state;
+  uint8_t bits;
+
+  void seed(uint16_t s) {
+    state = s ? s : 0xACE1; // all-zero state never leaves zero
+    bits = 0;
+  }
+
+  uint8_t nextByte() {
+    uint8_t out = state;
+    uint8_t feedback = state ^ (state >> 2) ^ (state >> 3) ^ (state >> 5);
+    state = (state >> 8) | ((uint16_t)feedback << 8);
+    return out;
+  }
+
+  // Addresses must be visited in ascending order from a multiple of 8
+  bool bitAt(uint32_t addr) {
+    if ((addr & 7) == 0) bits = nextByte();
+    return (bits >> (addr & 7)) & 1;
+  }
+};
+
+uint16_t lfsrSeed = 0xACE1; // change per run; printed so failures can be replayed
+
+// Pause that keeps written data alive, e.g. between a write and its read-back
+void idleWithRefresh(unsigned long ms) {
+  unsigned long start = millis();
+  while (millis() - start < ms) refreshIfNeeded();
+}
+
+uint32_t runLfsrPattern(uint16_t seed, unsigned long pause = 5) {
+  Serial.print(F("LFSR pattern, seed 0x"));
+  Serial.println(seed, HEX);
+
+  LfsrPattern lfsr;
+  uint32_t errors = 0;
+
+  lfsr.seed(seed);
   for (uint32_t addr = 0; addr < totalAddresses; addr++) {
-    unsigned long wt = writeBitTimed(addr, patternBit(patternID, addr));
-    writeStats.add(wt);
+    writeBit(addr, lfsr.bitAt(addr));
     if ((addr & 0xFFF) == 0) refreshIfNeeded();
   }
 
-  delay(5);
+  idleWithRefresh(pause);
+
+  lfsr.seed(seed);
+  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
+    bool expected = lfsr.bitAt(addr);
+    bool actual = readBit(addr);
+    if (actual != expected) {
+      reportError(addr, actual);
+      errors++;
+    }
+    if ((addr & 0xFFF) == 0) {
+      refreshIfNeeded();
+      if (abortRequested()) break;
+    }
+  }
+  flushFailures();
+
+  Serial.println(F("Pattern done.\n"));
+  return errors;
+}
+
+// Physical array layout. Logical addresses do not walk the die in order:
+// address bits are permuted on their way to the decoders, and with folded
+// bit lines every other pair of rows sits on the complement line, so a
+// logical 1 is stored as a discharged cell there. Neighbour and checkerboard
+// tests must work in physical coordinates or their aggressors end up far
+// from the victim. Hitachi does not publish the HM511000 scramble; the
+// tables below assume straight decoding and should be edited once a
+// sample's layout has been mapped.
+const uint16_t physRows = rowCount;
+const uint16_t physCols = colCount;
+
+// physical row/column bit i is driven by logical row/column bit [i];
+// only the first rowBits/colBits entries are used
+const uint8_t rowScramble[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+const uint8_t colScramble[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+const uint16_t complementRowMask = 0; // physical rows holding inverted data; none until mapped
+
+uint32_t logicalAddress(uint16_t prow, uint16_t pcol) {
+  uint16_t row = 0;
+  uint16_t col = 0;
+  for (uint8_t i = 0; i < rowBits; i++)
+    if ((prow >> i) & 1) row |= 1 << rowScramble[i];
+  for (uint8_t i = 0; i < colBits; i++)
+    if ((pcol >> i) & 1) col |= 1 << colScramble[i];
+  return makeAddress(row, col);
+}
+
+// DQ level that leaves a charge state of "0" in the given physical
+// background: 0 solid, 1 checkerboard, 2 row stripes, 3 column stripes.
+bool backgroundBit(uint8_t background, uint16_t prow, uint16_t pcol) {
+  bool charge;
+  switch (background) {
+    case 1: charge = (prow ^ pcol) & 1; break;
+    case 2: charge = prow & 1; break;
+    case 3: charge = pcol & 1; break;
+    default: charge = 0; break;
+  }
+  return charge ^ ((prow & complementRowMask) != 0);
+}
+
+// March element operations, data relative to the background
+enum MarchOp : uint8_t { R0, R1, W0, W1 };
+
+// Applies ops to every cell in physical row-major order, so consecutive
+// cells are physical column neighbours and each row is a neighbour row.
+uint32_t marchElement(bool descending, const MarchOp *ops, uint8_t count, uint8_t background) {
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < (uint32_t)physRows * physCols; i++) {
+    if ((i % physCols) == 0 && abortRequested()) break;
+    uint32_t cell = descending ? (uint32_t)physRows * physCols - 1 - i : i;
+    uint16_t prow = cell / physCols;
+    uint16_t pcol = cell % physCols;
+    uint32_t addr = logicalAddress(prow, pcol);
+    bool bg = backgroundBit(background, prow, pcol);
+
+    for (uint8_t k = 0; k < count; k++) {
+      bool isRead = ops[k] == R0 || ops[k] == R1;
+      if (!isRead) {
+        writeBit(addr, bg ^ (ops[k] == W1));
+        continue;
+      }
+
+      bool expected = bg ^ (ops[k] == R1);
+      bool actual;
+      // A read followed by a write of the same cell goes out as one RMW cycle
+      if (k + 1 < count && (ops[k + 1] == W0 || ops[k + 1] == W1)) {
+        actual = readModifyWriteBit(addr, bg ^ (ops[k + 1] == W1));
+        k++;
+      } else {
+        actual = readBit(addr);
+      }
+      if (actual != expected) {
+        reportError(addr, actual);
+        errors++;
+      }
+    }
+  }
+  flushFailures();
+  return errors;
+}
+
+// March C-: {⇕(w0); ⇑(r0,w1); ⇑(r1,w0); ⇓(r0,w1); ⇓(r1,w0); ⇕(r0)}.
+// Detects unlinked idempotent, inversion and state coupling faults between
+// any two cells; running it over several physical backgrounds adds the
+// data-dependent neighbourhood cases.
+uint32_t marchCMinus(uint8_t background) {
+  static const MarchOp w0[] = {W0};
+  static const MarchOp r0w1[] = {R0, W1};
+  static const MarchOp r1w0[] = {R1, W0};
+  static const MarchOp r0[] = {R0};
+
+  Serial.print(F("March C-, background "));
+  Serial.println(background);
+
+  uint32_t errors = 0;
+  errors += marchElement(false, w0, 1, background);
+  errors += marchElement(false, r0w1, 2, background);
+  errors += marchElement(false, r1w0, 2, background);
+  errors += marchElement(true, r0w1, 2, background);
+  errors += marchElement(true, r1w0, 2, background);
+  errors += marchElement(false, r0, 1, background);
+  return errors;
+}
+
+// Aggressor/victim test on the four physical neighbours of every cell.
+// The array holds a solid background; each victim's row and column
+// neighbours are flipped together and the victim must keep its value.
+uint32_t neighbourhoodTest(bool inverse) {
+  Serial.print(F("Neighbourhood test, victim "));
+  Serial.println(inverse ? "1" : "0");
+
+  static const MarchOp fill[] = {W0};
+  static const MarchOp fillInverse[] = {W1};
+  marchElement(false, inverse ? fillInverse : fill, 1, 0);
+
+  const int8_t dRow[4] = {-1, 1, 0, 0};
+  const int8_t dCol[4] = {0, 0, -1, 1};
+  uint32_t errors = 0;
+
+  for (uint16_t prow = 0; prow < physRows && !abortRequested(); prow++) {
+    for (uint16_t pcol = 0; pcol < physCols; pcol++) {
+      for (uint8_t n = 0; n < 4; n++) {
+        int16_t r = prow + dRow[n];
+        int16_t c = pcol + dCol[n];
+        if (r < 0 || r >= (int16_t)physRows || c < 0 || c >= (int16_t)physCols) continue;
+        writeBit(logicalAddress(r, c), backgroundBit(0, r, c) ^ !inverse);
+      }
+
+      uint32_t victim = logicalAddress(prow, pcol);
+      bool expected = backgroundBit(0, prow, pcol) ^ inverse;
+      bool actual = readBit(victim);
+      if (actual != expected) {
+        reportError(victim, actual);
+        errors++;
+      }
+
+      for (uint8_t n = 0; n < 4; n++) {
+        int16_t r = prow + dRow[n];
+        int16_t c = pcol + dCol[n];
+        if (r < 0 || r >= (int16_t)physRows || c < 0 || c >= (int16_t)physCols) continue;
+        writeBit(logicalAddress(r, c), backgroundBit(0, r, c) ^ inverse);
+      }
+    }
+  }
+  flushFailures();
+  return errors;
+}
+
+const uint8_t NO_PATTERN = 0xFF;
+
+// Pattern pass with cycle statistics. With `next` set, the read pass
+// verifies this pattern and writes the next one in the same RMW cycle, and
+// the following pass is started with `preloaded` to skip its write pass.
+// `pause` ms of refresh-only idle come before the read pass either way.
+void runPatternWithLatency(uint8_t patternID, bool preloaded = false, uint8_t next = NO_PATTERN,
+                           unsigned long pause = 5) {
+  Serial.print(F("Pattern "));
+  Serial.println(patternID);
+
+  LatencyStats writeStats, readStats;
+
+  if (!preloaded) {
+    for (uint32_t addr = 0; addr < totalAddresses; addr++) {
+      unsigned long wt = writeBitTimed(addr, patternBit(patternID, addr));
+      writeStats.add(wt);
+      if ((addr & 0xFFF) == 0) refreshIfNeeded();
+    }
+  }
+  idleWithRefresh(pause);
 
   for (uint32_t addr = 0; addr < totalAddresses; addr++) {
     bool actual;
-    unsigned long rt = readBitTimed(addr, actual);
+    unsigned long rt = next == NO_PATTERN
+                           ? readBitTimed(addr, actual)
+                           : readModifyWriteBitTimed(addr, patternBit(next, addr), actual);
     readStats.add(rt);
 
     bool expected = patternBit(patternID, addr);
-    if (actual != expected) {
-      Serial.print("ERR at 0x");
-      Serial.print(addr, HEX);
-      Serial.print(": expected ");
-      Serial.print(expected);
-      Serial.print(", got ");
-      Serial.println(actual);
+    if (actual != expected) reportError(addr, actual);
+
+    if ((addr & 0xFFF) == 0) {
+      refreshIfNeeded();
+      if (abortRequested()) break;
     }
+  }
+  flushFailures();
 
-    if ((addr & 0xFFF) == 0) refreshIfNeeded();
+  if (!preloaded) writeStats.print("Write latency");
+  readStats.print(next == NO_PATTERN ? "Read latency" : "Read-modify-write latency");
+  Serial.println(F("Pattern done.\n"));
+}
+
+// Access-time map. Rather than timing an edge, each cell is read with the
+// RAS-to-CAS and CAS-to-sample delays swept one CPU cycle at a time; the
+// smallest setting that still returns the stored value, for both a 0 and a
+// 1, is that cell's margin. Settings are in cycles above a fixed floor,
+// counted from the instructions between the edges: RAS→CAS is the sled
+// dispatch, two column writes and the CAS cbi; CAS→sample is the sled
+// dispatch and the PINC read, less one for the input synchronizer. At
+// 16 MHz both floors sit far above the tCAC of any supported part, so the
+// sweep only finds cells slower than the floor; a part with none reports
+// that instead of a map of zeros. Rows and columns with a slow cell stream
+// as they finish; the whole-chip histogram follows. A framebuffer can use
+// the worst cell plus one cycle of guard.
+const uint8_t SWEEP_STEPS = 16;
+const uint8_t SWEEP_FAIL = 0xFF;
+const uint8_t SWEEP_RCD_FLOOR = 10; // cycles
+const uint8_t SWEEP_CAC_FLOOR = 6;
+
+uint8_t worstCacOf(uint16_t col) {
+  return nibbleAt(col);
+}
+
+void raiseWorstCac(uint16_t col, uint8_t cac) {
+  if (cac > nibbleAt(col)) setNibble(col, cac);
+}
+
+// Busy-waits n CPU cycles (0–15) on top of a fixed 6-cycle dispatch: a
+// computed jump n words before the end of a NOP sled, so the cost does not
+// depend on how the compiler lays out a switch
+inline void delayCycles(uint8_t n) {
+#ifdef __AVR__
+  asm volatile(
+    "ldi r30, pm_lo8(1f)\n\t"
+    "ldi r31, pm_hi8(1f)\n\t"
+    "sub r30, %0\n\t"
+    "sbc r31, __zero_reg__\n\t"
+    "ijmp\n\t"
+    "nop\n\t nop\n\t nop\n\t nop\n\t nop\n\t"
+    "nop\n\t nop\n\t nop\n\t nop\n\t nop\n\t"
+    "nop\n\t nop\n\t nop\n\t nop\n\t nop\n"
+    "1:"
+    :: "r"(n) : "r30", "r31");
+#else
+  __builtin_avr_delay_cycles(6 + n);
+#endif
+}
+
+// DQ is pre-driven to the wrong level and released, so a sample taken
+// before the chip drives the line reads as a failure.
+bool readBitSwept(uint32_t addr, bool expected, uint8_t rcdCycles, uint8_t cacCycles) {
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+  uint8_t colD = addressPortD(col);
+  uint8_t colB = addressPortB(col);
+
+  DDRC |= (1 << DQ_BIT);
+  bitWrite(PORTC, DQ_BIT, !expected);
+  DDRC &= ~(1 << DQ_BIT);
+
+  setAddress(row);
+  uint8_t oldSREG = SREG;
+  cli();
+  PORTC &= ~(1 << RAS_BIT);
+  delayCycles(rcdCycles);
+  PORTD = colD;
+  PORTB = colB;
+  PORTC &= ~(1 << CAS_BIT);
+  delayCycles(cacCycles);
+  bool result = bitRead(PINC, DQ_BIT);
+  PORTC |= (1 << CAS_BIT);
+  PORTC |= (1 << RAS_BIT);
+  SREG = oldSREG;
+
+  PORTC &= ~(1 << DQ_BIT); // drop the pull-up left by a released 1
+  return result;
+}
+
+// Smallest sweep setting that reads back both levels, or SWEEP_FAIL
+uint8_t minWorkingDelay(uint32_t addr, bool sweepRcd) {
+  uint8_t worst = 0;
+  for (uint8_t value = 0; value <= 1; value++) {
+    writeBit(addr, value);
+    uint8_t step = 0;
+    while (step < SWEEP_STEPS) {
+      // readBitSwept() returns the level it sampled, not pass/fail
+      bool got = sweepRcd ? readBitSwept(addr, value, step, SWEEP_STEPS - 1)
+                          : readBitSwept(addr, value, SWEEP_STEPS - 1, step);
+      if (got == value) break;
+      step++;
+    }
+    if (step == SWEEP_STEPS) return SWEEP_FAIL;
+    if (step > worst) worst = step;
+  }
+  return worst;
+}
+
+void mapAccessLatency() {
+  Serial.print(F("Access-time map, 62.5ns steps above floors of tRCD "));
+  printNanos(SWEEP_RCD_FLOOR);
+  Serial.print(F(", tCAC "));
+  printNanos(SWEEP_CAC_FLOOR);
+  Serial.println();
+  if (chip.tCAC * 16UL < SWEEP_CAC_FLOOR * 1000UL) {
+    Serial.print(F("tCAC floor is above the "));
+    Serial.print(chip.tCAC);
+    Serial.println(F("ns spec: step 0 only means within the floor"));
+  }
+  Serial.println(F("LATROW row cac_p50 cac_p99 cac_max rcd_max"));
+
+  uint32_t chipCac[SWEEP_STEPS + 1] = {0}; // last bucket counts unreadable cells
+  uint8_t chipRcdMax = 0;
+  memset(nibbles, 0, sizeof(nibbles));
+
+  for (uint16_t row = 0; row < rowCount && !abortRequested(); row++) {
+    uint16_t rowCac[SWEEP_STEPS] = {0};
+    uint8_t rowCacMax = 0, rowRcdMax = 0;
+
+    for (uint16_t col = 0; col < colCount; col++) {
+      uint32_t addr = makeAddress(row, col);
+      uint8_t cac = minWorkingDelay(addr, false);
+      uint8_t rcd = minWorkingDelay(addr, true);
+
+      if (cac == SWEEP_FAIL || rcd == SWEEP_FAIL) {
+        reportError(addr, readBit(addr));
+        chipCac[SWEEP_STEPS]++;
+        continue;
+      }
+
+      rowCac[cac]++;
+      chipCac[cac]++;
+      if (cac > rowCacMax) rowCacMax = cac;
+      if (rcd > rowRcdMax) rowRcdMax = rcd;
+      raiseWorstCac(col, cac);
+    }
+    refreshIfNeeded();
+
+    uint16_t seen = 0;
+    uint8_t p50 = 0, p99 = 0;
+    for (uint8_t b = 0; b < SWEEP_STEPS; b++) {
+      uint16_t before = seen;
+      seen += rowCac[b];
+      if (before * 2 < colCount && seen * 2 >= colCount) p50 = b;
+      if (before * 100UL < colCount * 99UL && seen * 100UL >= colCount * 99UL) p99 = b;
+    }
+    if (rowRcdMax > chipRcdMax) chipRcdMax = rowRcdMax;
+    flushFailRow();
+    if (!rowCacMax && !rowRcdMax) continue; // whole row at the floor
+
+    Serial.print(F("LATROW "));
+    Serial.print(row);
+    Serial.print(' ');
+    Serial.print(p50);
+    Serial.print(' ');
+    Serial.print(p99);
+    Serial.print(' ');
+    Serial.print(rowCacMax);
+    Serial.print(' ');
+    Serial.println(rowRcdMax);
+  }
+
+  flushFailures();
+
+  uint8_t chipCacMax = 0;
+  for (uint8_t b = 0; b < SWEEP_STEPS; b++)
+    if (chipCac[b]) chipCacMax = b;
+  if (!chipCacMax && !chipRcdMax && !chipCac[SWEEP_STEPS]) {
+    Serial.print(F("Every cell read at the floor: the sweep cannot resolve this part below tRCD "));
+    printNanos(SWEEP_RCD_FLOOR);
+    Serial.print(F(", tCAC "));
+    printNanos(SWEEP_CAC_FLOOR);
+    Serial.println();
+    return;
+  }
+
+  Serial.println(F("LATCOL col cac_max"));
+  for (uint16_t col = 0; col < colCount; col++) {
+    if (!worstCacOf(col)) continue;
+    Serial.print(F("LATCOL "));
+    Serial.print(col);
+    Serial.print(' ');
+    Serial.println(worstCacOf(col));
+  }
+
+  Serial.println(F("LATHIST cycles cells"));
+  for (uint8_t b = 0; b <= SWEEP_STEPS; b++) {
+    if (!chipCac[b]) continue;
+    Serial.print(F("LATHIST "));
+    if (b == SWEEP_STEPS) Serial.print(F("fail"));
+    else Serial.print(b);
+    Serial.print(' ');
+    Serial.println(chipCac[b]);
+  }
+
+  Serial.print(F("Safe settings: tRCD sweep "));
+  Serial.print(chipRcdMax + 1);
+  Serial.print(F(" ("));
+  printNanos(SWEEP_RCD_FLOOR + chipRcdMax + 1);
+  Serial.print(F("), tCAC sweep "));
+  Serial.print(chipCacMax + 1);
+  Serial.print(F(" ("));
+  printNanos(SWEEP_CAC_FLOOR + chipCacMax + 1);
+  Serial.println(')');
+}
+
+// Steps of a full run, in order. Each one is the unit of resume.
+enum TestStep : uint8_t {
+  STEP_PRESCREEN = 0,
+  STEP_PATTERN_FIRST = 1,  // fixed patterns 0–6
+  STEP_LFSR = 8,
+  STEP_MARCH_FIRST = 9,    // March C- backgrounds 0–3
+  STEP_NEIGHBOUR_FIRST = 13,
+  STEP_LATENCY_MAP = 15,
+  STEP_DONE = 16
+};
+
+// Pattern already written by the previous step's read pass
+uint8_t preloadedPattern = NO_PATTERN;
+
+// Idle between fixed-pattern steps; batch mode skips it
+unsigned long stepPauseMillis = 1000;
+
+// Returns false when the run should stop here.
+bool runStep(uint8_t step) {
+  if (step == STEP_PRESCREEN) {
+    uint8_t faults = addressPrescreen();
+    checkpoint.errors += faults;
+    return faults == 0;
+  }
+
+  if (step < STEP_LFSR) {
+    // Consecutive patterns are chained through RMW read passes. A resumed
+    // run starts with nothing preloaded, so the first step writes its own.
+    uint8_t pattern = step - STEP_PATTERN_FIRST;
+    uint8_t next = step + 1 < STEP_LFSR ? pattern + 1 : NO_PATTERN;
+    runPatternWithLatency(pattern, preloadedPattern == pattern, next);
+    preloadedPattern = next;
+    idleWithRefresh(stepPauseMillis);
+  } else if (step == STEP_LFSR) {
+    runLfsrPattern(checkpoint.lfsrSeed);
+  } else if (step < STEP_NEIGHBOUR_FIRST) {
+    marchCMinus(step - STEP_MARCH_FIRST);
+  } else if (step < STEP_LATENCY_MAP) {
+    neighbourhoodTest(step - STEP_NEIGHBOUR_FIRST);
+  } else {
+    mapAccessLatency();
+  }
+  return !abortRequested();
+}
+
+void startNewRun() {
+  checkpoint.magic = CHECKPOINT_MAGIC;
+  checkpoint.step = STEP_PRESCREEN;
+  checkpoint.resumes = 0;
+  checkpoint.errors = 0;
+  checkpoint.stepErrors = 0;
+  checkpoint.firstFail = 0;
+  checkpoint.failedSteps = 0;
+  checkpoint.lfsrSeed = lfsrSeed;
+  saveCheckpoint();
+}
+
+// Picks up an unfinished run from EEPROM unless a fresh one was asked for
+void loadOrStartRun(bool fresh) {
+  EEPROM.get(CHECKPOINT_EEPROM_ADDR, checkpoint);
+
+  if (fresh || checkpoint.magic != CHECKPOINT_MAGIC || checkpoint.step >= STEP_DONE) {
+    startNewRun();
+    return;
+  }
+
+  // The step reruns from its start, so drop the errors it had already
+  // counted before the interruption
+  checkpoint.errors = checkpoint.stepErrors;
+  checkpoint.resumes++;
+  Serial.print(F("Resuming at step "));
+  Serial.print(checkpoint.step);
+  Serial.print(F(", errors so far "));
+  Serial.println(checkpoint.errors);
+  saveCheckpoint();
+}
+
+void printRunSummary() {
+  Serial.print(F("Run summary: errors="));
+  Serial.print(checkpoint.errors);
+  if (checkpoint.errors) {
+    Serial.print(F(" first=0x"));
+    Serial.print(checkpoint.firstFail, HEX);
+    Serial.print(F(" failed steps=0b"));
+    Serial.print(checkpoint.failedSteps, BIN);
+  }
+  Serial.print(F(" resumes="));
+  Serial.println(checkpoint.resumes);
+}
+
+void runFullTest(bool fresh) {
+  loadOrStartRun(fresh);
+
+  while (checkpoint.step < STEP_DONE) {
+    uint32_t errorsBefore = checkpoint.errors;
+    bool keepGoing = runStep(checkpoint.step);
+    if (checkpoint.errors != errorsBefore) checkpoint.failedSteps |= 1 << checkpoint.step;
+
+    if (!keepGoing) {
+      Serial.println(checkpoint.step == STEP_PRESCREEN ? "Prescreen failed, skipping pattern tests."
+                                                       : "Error threshold reached, aborting.");
+      checkpoint.step = STEP_DONE;
+      saveCheckpoint();
+      break;
+    }
+
+    checkpoint.step++;
+    checkpoint.stepErrors = checkpoint.errors;
+    saveCheckpoint();
+  }
+
+  printRunSummary();
+  Serial.println(F("All tests complete."));
+}
+
+// =======================================================================
+// Salvage batch mode
+// =======================================================================
+//
+// For sorting a lot of pulled chips. Switch the socket supply off, swap the
+// chip, switch it on and press the button (or send 't'). Each chip gets the
+// address prescreen and one LFSR pass; survivors get sampled retention and
+// access-time margins and then the pattern, March and neighbourhood steps.
+// The run ends in one line for the host logger (host/salvage_log.py):
+//
+//   RESULT,<n>,<chip>,<class>,<errors>,<first fail>,<failed steps>,
+//          <retention ms>,<tCAC sweep>,<tRCD sweep>,<seconds>
+//
+// Classes: ADDR prescreen failed, SCREEN LFSR pass failed, FAIL errors in
+// the full suite, WEAK retention under four refresh periods, PASS.
+//
+// Button on PC4 (A4) to GND; the on-board LED on PB5 is lit while a chip
+// is under test and blinks while waiting after a failure.
+
+#define BUTTON_BIT 4
+#define LED_BIT    5
+
+const uint8_t RETENTION_ROW_STEP = 16;   // rows sampled for retention
+const uint16_t RETENTION_FIRST_MS = 16;
+const uint16_t RETENTION_MAX_MS = 4096;
+const uint8_t MARGIN_GRID_SHIFT = 6;     // margins every 64th row and column
+
+bool batchMode = false;
+uint16_t batchCount = 0;
+bool lastChipFailed = false;
+
+inline bool buttonDown() {
+  return !(PINC & (1 << BUTTON_BIT));
+}
+
+// Longest refresh-free pause, doubling from RETENTION_FIRST_MS, after which
+// every sampled cell still holds a charge; 0 if the first pause leaks.
+uint16_t measureRetention() {
+  uint16_t good = 0;
+  for (uint16_t pause = RETENTION_FIRST_MS; pause <= RETENTION_MAX_MS; pause <<= 1) {
+    for (uint16_t prow = 0; prow < physRows; prow += RETENTION_ROW_STEP)
+      for (uint16_t pcol = 0; pcol < physCols; pcol++)
+        writeBit(logicalAddress(prow, pcol), !backgroundBit(0, prow, pcol));
+
+    refreshAllRows();
+    delay(pause);
+    lastRefreshMicros = micros(); // the read pass is the refresh
+
+    bool leaked = false;
+    for (uint16_t prow = 0; prow < physRows && !leaked; prow += RETENTION_ROW_STEP)
+      for (uint16_t pcol = 0; pcol < physCols && !leaked; pcol++)
+        leaked = readBit(logicalAddress(prow, pcol)) == backgroundBit(0, prow, pcol);
+    refreshAllRows();
+    lastRefreshMicros = micros();
+
+    if (leaked) break;
+    good = pause;
+  }
+  return good;
+}
+
+// Worst tCAC and tRCD sweep steps over a sparse grid of cells
+void sampleMargins(uint8_t &cacWorst, uint8_t &rcdWorst) {
+  cacWorst = rcdWorst = 0;
+  for (uint16_t row = 0; row < rowCount; row += 1 << MARGIN_GRID_SHIFT) {
+    for (uint16_t col = 0; col < colCount; col += 1 << MARGIN_GRID_SHIFT) {
+      uint32_t addr = makeAddress(row, col);
+      uint8_t cac = minWorkingDelay(addr, false);
+      uint8_t rcd = minWorkingDelay(addr, true);
+      if (cac > cacWorst) cacWorst = cac;
+      if (rcd > rcdWorst) rcdWorst = rcd;
+    }
+    refreshIfNeeded();
+  }
+}
+
+void waitForChip() {
+  parkPins();
+  Serial.println(F("Insert chip and press button"));
+
+  unsigned long blink = millis();
+  for (;;) {
+    if (buttonDown()) {
+      delay(20);
+      while (buttonDown()) {}
+      break;
+    }
+    if (Serial.available() && Serial.read() == 't') break;
+    if (lastChipFailed && millis() - blink >= 150) {
+      PORTB ^= (1 << LED_BIT);
+      blink = millis();
+    }
+  }
+
+  PORTB |= (1 << LED_BIT);
+  setupPins();
+}
+
+void testBatchChip() {
+  unsigned long start = millis();
+  batchCount++;
+
+  checkpoint.errors = 0;
+  checkpoint.firstFail = 0;
+  checkpoint.failedSteps = 0;
+  checkpoint.lfsrSeed = lfsrSeed + batchCount;
+  preloadedPattern = NO_PATTERN;
+  lastRefreshMicros = micros();
+
+  const char *result = "PASS";
+  uint16_t retention = 0;
+  uint8_t cac = 0, rcd = 0;
+
+  if (!runStep(STEP_PRESCREEN)) {
+    result = "ADDR";
+  } else {
+    runStep(STEP_LFSR);
+    if (checkpoint.errors) {
+      checkpoint.failedSteps |= 1 << STEP_LFSR;
+      result = "SCREEN";
+    }
   }
 
-  writeStats.print("Write latency");
-  readStats.print("Read latency");
-  Serial.println("Pattern done.\n");
+  if (!checkpoint.errors) {
+    retention = measureRetention();
+    sampleMargins(cac, rcd);
+
+    for (uint8_t step = STEP_PATTERN_FIRST; step < STEP_LATENCY_MAP; step++) {
+      if (step == STEP_LFSR) continue;
+      uint32_t errorsBefore = checkpoint.errors;
+      bool keepGoing = runStep(step);
+      if (checkpoint.errors != errorsBefore) checkpoint.failedSteps |= 1 << step;
+      if (!keepGoing) break;
+    }
+
+    if (checkpoint.errors) result = "FAIL";
+    else if (retention < 4 * chip.refreshMillis) result = "WEAK";
+  }
+
+  lastChipFailed = checkpoint.errors != 0;
+  PORTB &= ~(1 << LED_BIT);
+
+  Serial.print(F("RESULT,"));
+  Serial.print(batchCount);
+  Serial.print(',');
+  Serial.print(chip.name);
+  Serial.print(',');
+  Serial.print(result);
+  Serial.print(',');
+  Serial.print(checkpoint.errors);
+  Serial.print(F(",0x"));
+  Serial.print(checkpoint.firstFail, HEX);
+  Serial.print(F(",0x"));
+  Serial.print(checkpoint.failedSteps, HEX);
+  Serial.print(',');
+  Serial.print(retention);
+  Serial.print(',');
+  Serial.print(cac);
+  Serial.print(',');
+  Serial.print(rcd);
+  Serial.print(',');
+  Serial.println((millis() - start) / 1000);
+}
+
+void startBatchMode() {
+  batchMode = true;
+  stepPauseMillis = 0;
+  DDRB |= (1 << LED_BIT);
+  Serial.println(F("Batch mode"));
+}
+
+// =======================================================================
+// Soak mode
+// =======================================================================
+//
+// Send 's' during the startup delay and loop() runs passes forever. The
+// fixed patterns are chained through RMW read passes with a random
+// refresh-only pause between each write and its read-back; every eighth
+// pass is either an LFSR pass with a fresh seed and the same pause, or
+// March C- on a random background without one. One line per pass:
+//
+//   SOAK,<uptime s>,<pass>,<test>,<pause ms>,<pass errors>,<total errors>,
+//        <errors in the last hour>,<temperature C>
+//
+// Once an hour the rows that have failed follow as "SR <row> <count>"
+// lines; counts saturate at 15. The last-hour figure slides in 10-minute
+// steps.
+//
+// Optional thermistor for drift against temperature: 10k NTC from A5 (PC5)
+// to GND and 10k from A5 to 5V. The temperature column is "-" without it.
+
+const bool soakThermistor = false;
+#define THERMISTOR_PIN A5
+const float THERMISTOR_BETA = 3950.0;
+const float THERMISTOR_R25 = 10000.0; // also the series resistor
+
+const unsigned long SOAK_MAX_PAUSE_MS = 2000;
+const unsigned long SOAK_BUCKET_MS = 600000UL; // 10 min
+const uint8_t SOAK_BUCKETS = 6;
+const unsigned long SOAK_ROW_REPORT_MS = 3600000UL;
+
+bool soakMode = false;
+uint32_t soakPassCount = 0;
+uint32_t soakTotalErrors = 0;
+uint32_t soakBuckets[SOAK_BUCKETS];
+uint8_t soakBucket = 0;
+unsigned long soakBucketStart = 0;
+unsigned long soakRowReportAt = 0;
+
+float readTemperature() {
+  int adc = analogRead(THERMISTOR_PIN);
+  if (adc <= 0 || adc >= 1023) return NAN;
+  float r = THERMISTOR_R25 * adc / (1023 - adc);
+  return 1.0 / (log(r / THERMISTOR_R25) / THERMISTOR_BETA + 1.0 / 298.15) - 273.15;
+}
+
+uint32_t soakErrorsLastHour() {
+  while (millis() - soakBucketStart >= SOAK_BUCKET_MS) {
+    soakBucket = (soakBucket + 1) % SOAK_BUCKETS;
+    soakBuckets[soakBucket] = 0;
+    soakBucketStart += SOAK_BUCKET_MS;
+  }
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < SOAK_BUCKETS; i++) sum += soakBuckets[i];
+  return sum;
+}
+
+void printSoakRows() {
+  for (uint16_t row = 0; row < rowCount; row++) {
+    if (!nibbleAt(row)) continue;
+    Serial.print(F("SR "));
+    Serial.print(row);
+    Serial.print(' ');
+    Serial.println(nibbleAt(row));
+  }
 }
 
-void runFullTest() {
-  for (uint8_t pattern = 0; pattern <= 6; pattern++) {
-    runPatternWithLatency(pattern);
-    delay(1000);
+void soakPass() {
+  uint8_t slot = soakPassCount % 8;
+  bool lfsrPass = soakPassCount & 8;
+  unsigned long pause = slot < 7 || lfsrPass ? random(SOAK_MAX_PAUSE_MS + 1) : 0;
+
+  // The abort threshold applies per pass, so a bad chip keeps soaking
+  checkpoint.errors = 0;
+
+  if (slot < 7) {
+    uint8_t next = slot < 6 ? slot + 1 : NO_PATTERN;
+    runPatternWithLatency(slot, preloadedPattern == slot, next, pause);
+    preloadedPattern = next;
+  } else if (lfsrPass) {
+    runLfsrPattern(random(1, 0x10000), pause);
+  } else {
+    marchCMinus(random(4));
+  }
+
+  soakTotalErrors += checkpoint.errors;
+  soakErrorsLastHour();
+  soakBuckets[soakBucket] += checkpoint.errors;
+
+  Serial.print(F("SOAK,"));
+  Serial.print(millis() / 1000);
+  Serial.print(',');
+  Serial.print(soakPassCount);
+  Serial.print(',');
+  if (slot < 7) Serial.print(slot);
+  else Serial.print(lfsrPass ? F("lfsr") : F("march"));
+  Serial.print(',');
+  Serial.print(pause);
+  Serial.print(',');
+  Serial.print(checkpoint.errors);
+  Serial.print(',');
+  Serial.print(soakTotalErrors);
+  Serial.print(',');
+  Serial.print(soakErrorsLastHour());
+  Serial.print(',');
+  if (soakThermistor) Serial.println(readTemperature(), 1);
+  else Serial.println('-');
+
+  if (millis() - soakRowReportAt >= SOAK_ROW_REPORT_MS) {
+    printSoakRows();
+    soakRowReportAt = millis();
   }
-  Serial.println("All tests complete.");
+  soakPassCount++;
+}
+
+void startSoakMode() {
+  soakMode = true;
+  countRowErrors = true;
+  soakPassCount = soakTotalErrors = 0;
+  soakBucket = 0;
+  memset(nibbles, 0, sizeof(nibbles));
+  memset(soakBuckets, 0, sizeof(soakBuckets));
+  soakBucketStart = soakRowReportAt = millis();
+  randomSeed(micros() ^ analogRead(THERMISTOR_PIN));
+  Serial.println(F("Soak mode"));
 }
 
 void setup() {
-  Serial.begin(115200);
+  Serial.begin(LINK_BAUD);
+  Serial.print(F("DRAM test with port manipulation and latency, chip "));
+  Serial.println(chip.name);
+  Serial.println(F("Send 'n' now to discard a saved run, 's' to soak, 'b' or hold the button for batch mode"));
+  PORTC |= (1 << BUTTON_BIT); // pull-up
   delay(2000);
-  Serial.println("DRAM test with port manipulation and latency");
 
-  // Control lines
-  DDRC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
-  PORTC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
-
-  // Address lines
-  DDRD |= 0xFF;       // A0–A7
-  DDRB |= (1 << 2) | (1 << 3); // A8–A9
+  bool fresh = false;
+  bool batch = buttonDown();
+  bool soak = false;
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == 'n') fresh = true;
+    if (c == 'b') batch = true;
+    if (c == 's') soak = true;
+  }
 
-  DDRC |= (1 << DQ_BIT); // Default DQ output
-  runFullTest();
+  setupPins();
+  if (batch) startBatchMode();
+  else if (soak) startSoakMode();
+  else runFullTest(fresh);
 }
 
-void loop() {}
+void loop() {
+  if (batchMode) {
+    waitForChip();
+    testBatchChip();
+  } else if (soakMode) {
+    soakPass();
+  }
+}
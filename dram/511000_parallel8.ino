@@ -0,0 +1,231 @@
+// =======================================================================
+// Eight-chip parallel HM511000 tester (Arduino Mega R3)
+// =======================================================================
+//
+// Up to eight HM511000 chips share A0-A9, RAS, CAS and WE. Each chip's DQ
+// goes to its own bit of PORTA, so one port write drives the pattern bit
+// into all eight chips and one PINA read returns eight results at once.
+// Mismatches are XOR'd against the expected byte and counted per chip; each
+// pattern ends with one line of per-chip error counts.
+//
+// The Uno has no free 8-bit port (PD0/PD1 carry Serial, PORTC holds the
+// control lines), so this mode targets the Mega.
+//
+// Pin Connections (ATmega2560 on Arduino Mega R3):
+// - DQ of chip 0-7:      Pins 22-29 (PORTA, bit n = chip n)
+// - Address A0-A7:       Pins 37-30 (PORTC)
+// - Address A8-A9:       Pins 49, 48 (PL0, PL1)
+// - RAS, CAS, WE:        Pins 47, 46, 45 (PL2, PL3, PL4)
+//
+// Unused sockets should be left out of CHIP_MASK; their floating DQ lines
+// are ignored.
+//
+// =======================================================================
+
+#include <Arduino.h>
+#include "chip_profiles.h"
+
+// Sockets populated in this run (bit n = chip n on PA n)
+const uint8_t CHIP_MASK = 0xFF;
+const uint8_t CHIP_COUNT = 8;
+
+const unsigned long refreshInterval = refreshPeriodMicros / 2;
+unsigned long lastRefreshMicros = 0;
+
+// Shared control lines on PORTL
+#define RAS_BIT 2
+#define CAS_BIT 3
+#define WE_BIT  4
+
+#define DQ_PORT_OUT PORTA
+#define DQ_PORT_IN  PINA
+#define DQ_PORT_DDR DDRA
+
+// Per-chip results for the whole run, and for the pattern in progress
+uint32_t chipErrors[CHIP_COUNT];
+uint32_t chipFirstFail[CHIP_COUNT];
+uint32_t patternErrors[CHIP_COUNT];
+
+inline void setAddress(uint16_t addr) {
+  PORTC = addr & 0xFF;                                // A0–A7
+  PORTL = (PORTL & 0xFC) | ((addr >> 8) & 0x03);      // A8–A9
+}
+
+void refreshAllRows() {
+  for (uint16_t row = 0; row < chip.refreshRows; row++) {
+    setAddress(row);
+    PORTL &= ~(1 << RAS_BIT); // RAS low
+    delayMicroseconds(1);
+    PORTL |= (1 << RAS_BIT);  // RAS high
+  }
+}
+
+// Called on every access: one access takes several µs, so any fixed
+// address stride would outlast the refresh period on a slow pass
+void refreshIfNeeded() {
+  unsigned long now = micros();
+  if (now - lastRefreshMicros >= refreshInterval) {
+    refreshAllRows();
+    lastRefreshMicros = now;
+  }
+}
+
+// Pause that keeps every chip's data alive
+void idleWithRefresh(unsigned long ms) {
+  unsigned long start = millis();
+  while (millis() - start < ms) refreshIfNeeded();
+}
+
+// Writes the same byte lane to every chip; bit n of value goes to chip n.
+void writeByteAll(uint32_t addr, uint8_t value) {
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+
+  DQ_PORT_DDR = 0xFF;
+  DQ_PORT_OUT = value;
+
+  setAddress(row);
+  PORTL &= ~(1 << RAS_BIT);
+  delayMicroseconds(1);
+
+  setAddress(col);
+  PORTL &= ~(1 << CAS_BIT);
+  delayMicroseconds(1);
+
+  PORTL &= ~(1 << WE_BIT);
+  delayMicroseconds(1);
+
+  PORTL |= (1 << WE_BIT) | (1 << CAS_BIT) | (1 << RAS_BIT);
+}
+
+// Returns the DQ of every chip at addr in one PINA read.
+uint8_t readByteAll(uint32_t addr) {
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+
+  DQ_PORT_DDR = 0x00;
+  DQ_PORT_OUT = 0x00; // no pull-ups, floating sockets read as noise only
+
+  setAddress(row);
+  PORTL &= ~(1 << RAS_BIT);
+  delayMicroseconds(1);
+
+  setAddress(col);
+  PORTL &= ~(1 << CAS_BIT);
+  delayMicroseconds(1);
+
+  uint8_t result = DQ_PORT_IN;
+
+  PORTL |= (1 << CAS_BIT) | (1 << RAS_BIT);
+  return result;
+}
+
+bool patternBit(uint8_t patternID, uint32_t addr) {
+  switch (patternID) {
+    case 0: return 0;
+    case 1: return 1;
+    case 2: return addr & 1;
+    case 3: return (addr >> 1) & 1;
+    case 4: return (addr >> colBits) & 1;
+    case 5: return addr & 0xFFFF & 1;
+    case 6: return (~addr) & 1;
+    default: return 0;
+  }
+}
+
+void recordFailures(uint32_t addr, uint8_t failMask) {
+  for (uint8_t lane = 0; lane < CHIP_COUNT; lane++) {
+    if (failMask & (1 << lane)) {
+      if (chipErrors[lane] == 0) chipFirstFail[lane] = addr;
+      chipErrors[lane]++;
+      patternErrors[lane]++;
+    }
+  }
+}
+
+// One line per pattern instead of one per failing address, so a bad chip
+// cannot stall the read pass on Serial while the others go unrefreshed
+void printPatternErrors() {
+  Serial.print(F("Errors per chip:"));
+  for (uint8_t lane = 0; lane < CHIP_COUNT; lane++) {
+    if (!(CHIP_MASK & (1 << lane))) continue;
+    Serial.print(' ');
+    Serial.print(patternErrors[lane]);
+  }
+  Serial.println();
+}
+
+void runPattern(uint8_t patternID) {
+  Serial.print(F("Pattern "));
+  Serial.println(patternID);
+
+  for (uint8_t lane = 0; lane < CHIP_COUNT; lane++) patternErrors[lane] = 0;
+
+  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
+    writeByteAll(addr, patternBit(patternID, addr) ? 0xFF : 0x00);
+    refreshIfNeeded();
+  }
+
+  idleWithRefresh(5);
+
+  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
+    uint8_t expected = patternBit(patternID, addr) ? 0xFF : 0x00;
+    uint8_t failMask = (readByteAll(addr) ^ expected) & CHIP_MASK;
+    if (failMask) recordFailures(addr, failMask);
+    refreshIfNeeded();
+  }
+
+  printPatternErrors();
+  Serial.println(F("Pattern done."));
+}
+
+void printChipReport() {
+  Serial.println(F("Per-chip results:"));
+  for (uint8_t lane = 0; lane < CHIP_COUNT; lane++) {
+    if (!(CHIP_MASK & (1 << lane))) continue;
+    Serial.print(F("  Chip "));
+    Serial.print(lane);
+    if (chipErrors[lane] == 0) {
+      Serial.println(F(": PASS"));
+    } else {
+      Serial.print(F(": FAIL errors="));
+      Serial.print(chipErrors[lane]);
+      Serial.print(F(" first=0x"));
+      Serial.println(chipFirstFail[lane], HEX);
+    }
+  }
+}
+
+void runFullTest() {
+  for (uint8_t lane = 0; lane < CHIP_COUNT; lane++) {
+    chipErrors[lane] = 0;
+    chipFirstFail[lane] = 0;
+  }
+
+  for (uint8_t pattern = 0; pattern <= 6; pattern++) {
+    runPattern(pattern);
+    idleWithRefresh(1000);
+  }
+
+  printChipReport();
+  Serial.println(F("All tests complete."));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+  Serial.println(F("8-chip parallel DRAM test"));
+
+  // Control lines idle high
+  DDRL |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
+  PORTL |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
+
+  // Address lines
+  DDRC = 0xFF;                 // A0–A7
+  DDRL |= (1 << 0) | (1 << 1); // A8–A9
+
+  DQ_PORT_DDR = 0xFF; // Default DQ output
+  runFullTest();
+}
+
+void loop() {}
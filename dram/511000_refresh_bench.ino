@@ -0,0 +1,112 @@
+// Refresh strategy benchmark. For each mode in dram_core.h it times a full
+// write and read pass, counts refresh cycles and read-back errors, then
+// checks retention: the array is filled, left idle for RETENTION_IDLE_MS
+// with only that strategy keeping it alive (dummy reads for hidden
+// refresh, which has nothing else to ride on) and read back. The last line
+// names the fastest mode that lost no data.
+
+#include "dram_core.h"
+
+const unsigned long RETENTION_IDLE_MS = 4000;
+
+struct BenchResult {
+  unsigned long writeMillis;
+  unsigned long readMillis;
+  uint32_t refreshes;
+  uint32_t errors;
+  uint32_t retentionErrors;
+};
+
+BenchResult results[REFRESH_MODE_COUNT];
+
+void writePass(uint8_t patternID) {
+  for (uint32_t addr = 0; addr < totalAddresses; addr++)
+    writeBit(addr, patternBit(patternID, addr));
+}
+
+uint32_t readPass(uint8_t patternID) {
+  uint32_t errors = 0;
+  for (uint32_t addr = 0; addr < totalAddresses; addr++)
+    if (readBit(addr) != patternBit(patternID, addr)) errors++;
+  return errors;
+}
+
+void idleRefreshed(unsigned long ms) {
+  unsigned long start = millis();
+  while (millis() - start < ms) {
+    if (refreshMode == REFRESH_HIDDEN) readBit(0);
+    else refreshIfNeeded();
+  }
+}
+
+// Addresses per second for one pass
+uint32_t passRate(unsigned long ms) {
+  return ms ? totalAddresses * 1000UL / ms : 0;
+}
+
+void benchMode(uint8_t mode) {
+  BenchResult &r = results[mode];
+  setRefreshMode((RefreshMode)mode);
+  refreshCycles = 0;
+
+  unsigned long t0 = millis();
+  writePass(2);
+  unsigned long t1 = millis();
+  r.errors = readPass(2);
+  unsigned long t2 = millis();
+  r.writeMillis = t1 - t0;
+  r.readMillis = t2 - t1;
+  r.refreshes = refreshCycles;
+
+  writePass(6);
+  idleRefreshed(RETENTION_IDLE_MS);
+  r.retentionErrors = readPass(6);
+}
+
+void printResult(uint8_t mode) {
+  const BenchResult &r = results[mode];
+  Serial.print(refreshModeName(mode));
+  Serial.print(F(": write "));
+  Serial.print(passRate(r.writeMillis));
+  Serial.print(F("/s, read "));
+  Serial.print(passRate(r.readMillis));
+  Serial.print(F("/s, "));
+  Serial.print(r.refreshes);
+  Serial.print(F(" refreshes, errors "));
+  Serial.print(r.errors);
+  Serial.print(F(", retention errors "));
+  Serial.println(r.retentionErrors);
+}
+
+void setup() {
+  Serial.begin(LINK_BAUD);
+  delay(1000);
+  Serial.println(F("HM511000 refresh strategy benchmark"));
+  Serial.print(F("Chip: "));
+  Serial.println(chip.name);
+
+  setupPins();
+  int8_t best = -1;
+  unsigned long bestMillis = 0;
+  for (uint8_t mode = 0; mode < REFRESH_MODE_COUNT; mode++) {
+    benchMode(mode);
+    printResult(mode);
+    const BenchResult &r = results[mode];
+    unsigned long total = r.writeMillis + r.readMillis;
+    if (r.errors || r.retentionErrors) continue;
+    if (best < 0 || total < bestMillis) {
+      best = mode;
+      bestMillis = total;
+    }
+  }
+  setRefreshMode(REFRESH_BURST);
+
+  if (best < 0) {
+    Serial.println(F("No mode kept the data"));
+  } else {
+    Serial.print(F("Cheapest correct refresh: "));
+    Serial.println(refreshModeName(best));
+  }
+}
+
+void loop() {}
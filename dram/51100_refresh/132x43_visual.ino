@@ -1,42 +1,85 @@
-#include <Arduino.h>
+// Memory cluster visualizer: a VT100 front end for the shared tester
+// core. The map shows the whole chip or a zoomed band of rows at 80x25
+// or 132x43; cells are painted as the passes sweep through them and
+// errors are kept for a cluster summary at the end.
+//
+// Keys within 3 s of reset: 'g' next geometry, '+'/'-' zoom in/out,
+// '<'/'>' previous/next band, Enter starts at once.
+
+// The Uno has 2 KB of RAM: the error log below plus the TX ring, status
+// buffer and RX ring come to about 1150 bytes with these sizes. Every
+// string and the cell tables stay in flash.
+#define TX_RING_SIZE 128
+#include "../dram_frontend_vt100.h"
 
-const int addrPins[10] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11}; // A0–A9
-const int dqPin = A0;
-const int rasPin = A1;
-const int casPin = A2;
-const int wePin = A3;
+const int CLUSTER_THRESHOLD = 3; // Minimum errors for cluster detection
 
-const unsigned long totalAddresses = 131072UL; // 2^17 (128KB)
-const unsigned long refreshInterval = 250;     // µs per refresh (64ms/256)
-unsigned long lastRefreshMicros = 0;
+// Terminal layouts. The map is 1 << widthShift cells wide and at most
+// `height` rows tall; the frame, cluster summary, progress bar and
+// result line stack below it.
+struct MapGeometry {
+  const char *name;
+  uint8_t widthShift;
+  uint8_t height;
+  uint8_t termCols;
+};
 
-// Memory visualization constants
-const int MAP_WIDTH = 128;   // Memory map display width
-const int MAP_HEIGHT = 32;   // Memory map display height
-const int CLUSTER_THRESHOLD = 3; // Minimum errors for cluster detection
+const MapGeometry geometries[] = {
+  {"80x25", 6, 13, 80},
+  {"132x43", 7, 32, 132},
+};
+const uint8_t GEOMETRY_COUNT = sizeof(geometries) / sizeof(geometries[0]);
+
+// Zoom n shows totalAddresses >> n addresses, down to a single row
+const uint8_t MAX_ZOOM = addressBits - colBits;
+
+uint8_t geometryIndex = 1;
+uint8_t zoomLevel = 0;
+uint16_t bandRow = 0; // first row of the zoomed window
+
+// Derived from the selection by applyGeometry(), so placing an address
+// on the map is a subtract, a compare and shifts
+uint8_t mapWidthShift;
+uint8_t mapWidth;
+uint8_t mapRows;
+uint8_t cellShift;    // addresses per cell = 1 << cellShift
+uint32_t windowBase;
+uint32_t windowSize;
+uint16_t cellCount;
+uint8_t frameBottomRow;
+uint8_t analysisRow;  // three lines
+uint8_t progressRow;
+uint8_t resultRow;
+
+const uint16_t NO_CELL = 0xFFFF;
+
+void applyGeometry() {
+  const MapGeometry &g = geometries[geometryIndex];
+  mapWidthShift = g.widthShift;
+  mapWidth = 1 << g.widthShift;
+
+  windowSize = totalAddresses >> zoomLevel;
+  windowBase = ((uint32_t)bandRow << colBits) & ~(windowSize - 1);
+  bandRow = windowBase >> colBits;
+
+  // Fewest addresses per cell that still fit the window in `height` rows
+  cellShift = 0;
+  while ((windowSize >> cellShift >> mapWidthShift) > g.height) cellShift++;
+  cellCount = windowSize >> cellShift;
+  mapRows = (cellCount + mapWidth - 1) >> mapWidthShift;
+
+  frameBottomRow = 6 + mapRows;
+  analysisRow = frameBottomRow + 1;
+  progressRow = analysisRow + 3;
+  resultRow = progressRow + 1;
+}
 
-// Enhanced VT100 Escape Codes
-#define VT_CLEAR_SCREEN "\x1b[2J"
-#define VT_CURSOR_HOME "\x1b[H"
-#define VT_COLOR_RED "\x1b[31m"
-#define VT_COLOR_GREEN "\x1b[32m"
-#define VT_COLOR_YELLOW "\x1b[33m"
-#define VT_COLOR_BLUE "\x1b[34m"
-#define VT_COLOR_MAGENTA "\x1b[35m"
-#define VT_COLOR_CYAN "\x1b[36m"
-#define VT_COLOR_WHITE "\x1b[37m"
-#define VT_COLOR_RESET "\x1b[0m"
-#define VT_CURSOR_SAVE "\x1b[s"
-#define VT_CURSOR_RESTORE "\x1b[u"
-#define VT_CURSOR_HIDE "\x1b[?25l"
-#define VT_CURSOR_SHOW "\x1b[?25h"
-#define VT_BOLD "\x1b[1m"
-#define VT_DIM "\x1b[2m"
-#define VT_BLINK "\x1b[5m"
-#define VT_REVERSE "\x1b[7m"
-#define VT_BG_RED "\x1b[41m"
-#define VT_BG_GREEN "\x1b[42m"
-#define VT_BG_YELLOW "\x1b[43m"
+// Map cell of an address, or NO_CELL outside the window
+inline uint16_t cellOf(uint32_t addr) {
+  uint32_t offset = addr - windowBase;
+  if (offset >= windowSize) return NO_CELL;
+  return offset >> cellShift;
+}
 
 // Error tracking structure for cluster analysis
 struct ErrorInfo {
@@ -46,171 +89,156 @@ struct ErrorInfo {
   bool actual;
 };
 
-ErrorInfo errorLog[256]; // Store up to 256 errors for analysis
-int errorCount = 0;
-int clusterCount = 0;
+const int ERROR_LOG_SIZE = 128; // 7 bytes each
+ErrorInfo errorLog[ERROR_LOG_SIZE]; // first errors, kept for cluster analysis
+uint32_t errorCount = 0; // all errors, logged or not
 
-// Function declarations
-void setAddress(uint16_t addr);
-void writeBit(uint32_t addr, bool value);
-bool readBit(uint32_t addr);
-void refreshIfNeeded();
-void refreshAllRows();
-void runPattern(uint8_t patternID);
-bool patternBit(uint8_t patternID, uint32_t addr);
-void runFullTest();
-void initializeDisplay();
-void drawMemoryMap(uint8_t patternID);
-void updateMemoryCell(uint32_t addr, bool hasError, bool isActive);
-void drawClusterAnalysis();
-void drawStatusPanel();
-void updateProgressBar(unsigned long current, unsigned long total, int row, int col);
-void printVT100Status(const char* message, int row, int col, const char* color);
-void detectClusters();
-void drawLegend();
-void drawHeader();
-void logError(uint32_t addr, uint8_t pattern, bool expected, bool actual);
-uint32_t addrToMapCoord(uint32_t addr, bool getX);
+int loggedErrors() {
+  return errorCount < ERROR_LOG_SIZE ? errorCount : ERROR_LOG_SIZE;
+}
+int clusterCount = 0;
 
-void setup() {
-  Serial.begin(115200);
-  delay(1000);
+// Cells lying wholly below addr
+uint16_t cellsBelow(uint32_t addr) {
+  if (addr <= windowBase) return 0;
+  uint32_t offset = addr - windowBase;
+  return offset >= windowSize ? cellCount : offset >> cellShift;
+}
 
-  pinMode(rasPin, OUTPUT);
-  pinMode(casPin, OUTPUT);
-  pinMode(wePin, OUTPUT);
-  digitalWrite(rasPin, HIGH);
-  digitalWrite(casPin, HIGH);
-  digitalWrite(wePin, HIGH);
+// Map painting keeps track of the terminal's cursor and colour, so a run
+// of cells along a map row costs only its glyphs
+enum CellState : uint8_t { CELL_GOOD, CELL_ERROR, CELL_ACTIVE, CELL_CLUSTER, CELL_UNKNOWN };
 
-  for (int i = 0; i < 10; i++) {
-    pinMode(addrPins[i], OUTPUT);
-  }
-  pinMode(dqPin, OUTPUT);
-
-  initializeDisplay();
-  runFullTest();
+// Fixed-width rows, so each one prints straight from flash
+const char cellStyle[][18] PROGMEM = {
+  VT_COLOR_RESET VT_COLOR_GREEN,
+  VT_COLOR_RESET VT_COLOR_RED VT_BOLD,
+  VT_COLOR_RESET VT_COLOR_YELLOW VT_BLINK,
+  VT_COLOR_RESET VT_COLOR_MAGENTA VT_BOLD VT_BLINK,
+};
+const char cellGlyph[][4] PROGMEM = {"·", "●", "●", "●"};
 
-  Serial.print(VT_CURSOR_SHOW);
+inline const __FlashStringHelper *flashString(const char *p) {
+  return (const __FlashStringHelper *)p;
 }
 
-void loop() {
-  // Empty - test runs once
-}
+uint16_t cursorCell = NO_CELL;      // cell the cursor sits on
+uint8_t cursorState = CELL_UNKNOWN; // style currently selected
 
-void initializeDisplay() {
-  Serial.print(VT_CLEAR_SCREEN);
-  Serial.print(VT_CURSOR_HOME);
-  Serial.print(VT_CURSOR_HIDE);
-  
-  drawHeader();
-  drawLegend();
-  drawStatusPanel();
-  
-  // Draw memory map frame
-  Serial.print("\x1b[5;1H");
-  Serial.print(VT_COLOR_CYAN);
-  Serial.print("┌");
-  for (int i = 0; i < MAP_WIDTH; i++) Serial.print("─");
-  Serial.println("┐");
-  
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    Serial.print("\x1b[");
-    Serial.print(6 + y);
-    Serial.print(";1H│");
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      Serial.print("·"); // Default memory cell representation
-    }
-    Serial.println("│");
+void paintCell(uint16_t cell, uint8_t state) {
+  if (cell != cursorCell || (cell & (mapWidth - 1)) == 0) {
+    vtMoveTo(6 + (cell >> mapWidthShift), 2 + (cell & (mapWidth - 1)));
   }
-  
-  Serial.print("\x1b[");
-  Serial.print(6 + MAP_HEIGHT);
-  Serial.print(";1H└");
-  for (int i = 0; i < MAP_WIDTH; i++) Serial.print("─");
-  Serial.print("┘");
-  Serial.print(VT_COLOR_RESET);
+  if (state != cursorState) {
+    Serial.print(flashString(cellStyle[state]));
+    cursorState = state;
+  }
+  Serial.print(flashString(cellGlyph[state]));
+  cursorCell = cell + 1;
+}
+
+// Call before printing anything else
+void releaseCursor() {
+  if (cursorState != CELL_UNKNOWN) Serial.print(F(VT_COLOR_RESET));
+  cursorCell = NO_CELL;
+  cursorState = CELL_UNKNOWN;
 }
 
 void drawHeader() {
-  Serial.print(VT_CURSOR_HOME);
-  Serial.print(VT_BOLD VT_COLOR_WHITE);
-  Serial.print("DRAM Memory Cluster Visualizer - 128KB (131,072 addresses)");
-  Serial.print(VT_COLOR_RESET);
-  Serial.print("\x1b[2;1H");
-  Serial.print("═══════════════════════════════════════════════════════════════════════════════════════════════════════════════════════════════════════");
+  Serial.print(F(VT_CURSOR_HOME));
+  Serial.print(F(VT_BOLD VT_COLOR_WHITE));
+  Serial.print(F("DRAM Memory Cluster Visualizer - "));
+  Serial.print(chip.name);
+  if (zoomLevel == 0) {
+    Serial.print(F(" ("));
+    Serial.print(totalAddresses);
+    Serial.print(F(" addresses)"));
+  } else {
+    Serial.print(F(" rows "));
+    Serial.print(bandRow);
+    Serial.print('-');
+    Serial.print(bandRow + (windowSize >> colBits) - 1);
+  }
+  Serial.print(F(", "));
+  Serial.print(1UL << cellShift);
+  Serial.print(F(" per cell"));
+  Serial.print(F(VT_COLOR_RESET));
+  Serial.print(F("\x1b[2;1H"));
+  for (uint8_t i = 0; i < geometries[geometryIndex].termCols; i++) Serial.print(F("═"));
 }
 
 void drawLegend() {
-  Serial.print("\x1b[3;1H");
-  Serial.print("Legend: ");
-  Serial.print(VT_COLOR_GREEN "●" VT_COLOR_RESET " Good ");
-  Serial.print(VT_COLOR_RED "●" VT_COLOR_RESET " Error ");
-  Serial.print(VT_COLOR_YELLOW "●" VT_COLOR_RESET " Testing ");
-  Serial.print(VT_COLOR_MAGENTA "●" VT_COLOR_RESET " Cluster ");
-  Serial.print("| Patterns: 0=All0s 1=All1s 2=0101 3=0011 4=RowParity 5=AddrLSB 6=~AddrLSB");
+  Serial.print(F("\x1b[3;1H"));
+  Serial.print(F("Legend: "));
+  Serial.print(F(VT_COLOR_GREEN "●" VT_COLOR_RESET " Good "));
+  Serial.print(F(VT_COLOR_RED "●" VT_COLOR_RESET " Error "));
+  Serial.print(F(VT_COLOR_YELLOW "●" VT_COLOR_RESET " Testing "));
+  Serial.print(F(VT_COLOR_MAGENTA "●" VT_COLOR_RESET " Cluster "));
+  if (geometries[geometryIndex].termCols >= 132) {
+    Serial.print(F("| Patterns: 0=All0s 1=All1s 2=0101 3=0011 4=RowParity 5=AddrLSB 6=~AddrLSB"));
+  }
 }
 
 void drawStatusPanel() {
-  Serial.print("\x1b[4;1H");
-  Serial.print("Status: ");
-  Serial.print(VT_COLOR_CYAN "Initializing..." VT_COLOR_RESET);
-  Serial.print(" | Errors: 0 | Clusters: 0 | Progress: 0%");
+  Serial.print(F("\x1b[4;1H"));
+  Serial.print(F("Status: "));
+  Serial.print(F(VT_COLOR_CYAN "Initializing..." VT_COLOR_RESET));
+  Serial.print(F(" | Errors: 0 | Clusters: 0 | Progress: 0%"));
 }
 
-uint32_t addrToMapCoord(uint32_t addr, bool getX) {
-  // Map 17-bit address space (131072) to 128x32 display
-  uint32_t normalized = addr / (totalAddresses / (MAP_WIDTH * MAP_HEIGHT));
-  if (getX) {
-    return normalized % MAP_WIDTH;
-  } else {
-    return normalized / MAP_WIDTH;
-  }
-}
+void initializeDisplay() {
+  Serial.print(F(VT_CLEAR_SCREEN));
+  Serial.print(F(VT_CURSOR_HOME));
+  Serial.print(F(VT_CURSOR_HIDE));
 
-void updateMemoryCell(uint32_t addr, bool hasError, bool isActive) {
-  uint32_t x = addrToMapCoord(addr, true);
-  uint32_t y = addrToMapCoord(addr, false);
-  
-  if (x >= MAP_WIDTH || y >= MAP_HEIGHT) return;
-  
-  Serial.print(VT_CURSOR_SAVE);
-  Serial.print("\x1b[");
-  Serial.print(6 + y);
-  Serial.print(";");
-  Serial.print(2 + x);
-  Serial.print("H");
-  
-  if (isActive) {
-    Serial.print(VT_COLOR_YELLOW VT_BLINK "●" VT_COLOR_RESET);
-  } else if (hasError) {
-    Serial.print(VT_COLOR_RED VT_BOLD "●" VT_COLOR_RESET);
-  } else {
-    Serial.print(VT_COLOR_GREEN "·" VT_COLOR_RESET);
+  drawHeader();
+  drawLegend();
+  drawStatusPanel();
+
+  // Draw memory map frame
+  Serial.print(F("\x1b[5;1H"));
+  Serial.print(F(VT_COLOR_CYAN));
+  Serial.print(F("┌"));
+  for (int i = 0; i < mapWidth; i++) Serial.print(F("─"));
+  Serial.println(F("┐"));
+
+  for (int y = 0; y < mapRows; y++) {
+    Serial.print(F("\x1b["));
+    Serial.print(6 + y);
+    Serial.print(F(";1H│"));
+    for (int x = 0; x < mapWidth; x++) {
+      Serial.print(F("·")); // Default memory cell representation
+    }
+    Serial.println(F("│"));
   }
-  
-  Serial.print(VT_CURSOR_RESTORE);
-  Serial.flush();
+
+  Serial.print(F("\x1b["));
+  Serial.print(frameBottomRow);
+  Serial.print(F(";1H└"));
+  for (int i = 0; i < mapWidth; i++) Serial.print(F("─"));
+  Serial.print(F("┘"));
+  Serial.print(F(VT_COLOR_RESET));
 }
 
 void logError(uint32_t addr, uint8_t pattern, bool expected, bool actual) {
-  if (errorCount < 256) {
+  if (errorCount < ERROR_LOG_SIZE) {
     errorLog[errorCount].address = addr;
     errorLog[errorCount].pattern = pattern;
     errorLog[errorCount].expected = expected;
     errorLog[errorCount].actual = actual;
-    errorCount++;
   }
+  errorCount++;
 }
 
 void detectClusters() {
   clusterCount = 0;
+  int logged = loggedErrors();
   // Simple clustering: count errors within proximity
-  for (int i = 0; i < errorCount; i++) {
+  for (int i = 0; i < logged; i++) {
     int nearby = 0;
     uint32_t baseAddr = errorLog[i].address;
     
-    for (int j = 0; j < errorCount; j++) {
+    for (int j = 0; j < logged; j++) {
       if (i != j) {
         uint32_t distance = abs((int32_t)baseAddr - (int32_t)errorLog[j].address);
         if (distance < 1024) { // Within 1KB range
@@ -221,48 +249,37 @@ void detectClusters() {
     
     if (nearby >= CLUSTER_THRESHOLD) {
       clusterCount++;
-      // Mark cluster on map
-      uint32_t x = addrToMapCoord(baseAddr, true);
-      uint32_t y = addrToMapCoord(baseAddr, false);
-      
-      if (x < MAP_WIDTH && y < MAP_HEIGHT) {
-        Serial.print(VT_CURSOR_SAVE);
-        Serial.print("\x1b[");
-        Serial.print(6 + y);
-        Serial.print(";");
-        Serial.print(2 + x);
-        Serial.print("H");
-        Serial.print(VT_COLOR_MAGENTA VT_BOLD VT_BLINK "●" VT_COLOR_RESET);
-        Serial.print(VT_CURSOR_RESTORE);
-      }
+      uint16_t cell = cellOf(baseAddr);
+      if (cell != NO_CELL) paintCell(cell, CELL_CLUSTER);
     }
   }
+  releaseCursor();
 }
 
 void drawClusterAnalysis() {
-  Serial.print("\x1b[39;1H");
-  Serial.print(VT_COLOR_CYAN "Cluster Analysis:" VT_COLOR_RESET);
-  Serial.print("\x1b[40;1H");
-  Serial.print("Total Errors: ");
-  Serial.print(VT_COLOR_RED);
+  vtMoveTo(analysisRow, 1);
+  Serial.print(F(VT_COLOR_CYAN "Cluster Analysis:" VT_COLOR_RESET));
+  vtMoveTo(analysisRow + 1, 1);
+  Serial.print(F("Total Errors: "));
+  Serial.print(F(VT_COLOR_RED));
   Serial.print(errorCount);
-  Serial.print(VT_COLOR_RESET);
-  Serial.print(" | Detected Clusters: ");
-  Serial.print(VT_COLOR_MAGENTA);
+  Serial.print(F(VT_COLOR_RESET));
+  Serial.print(F(" | Detected Clusters: "));
+  Serial.print(F(VT_COLOR_MAGENTA));
   Serial.print(clusterCount);
-  Serial.print(VT_COLOR_RESET);
+  Serial.print(F(VT_COLOR_RESET));
   
   if (clusterCount > 0) {
-    Serial.print(" | ");
-    Serial.print(VT_COLOR_RED VT_BLINK "CRITICAL: Memory degradation detected!" VT_COLOR_RESET);
+    Serial.print(F(" | "));
+    Serial.print(F(VT_COLOR_RED VT_BLINK "CRITICAL: Memory degradation detected!" VT_COLOR_RESET));
   }
   
-  Serial.print("\x1b[41;1H");
+  vtMoveTo(analysisRow + 2, 1);
   if (errorCount > 0) {
-    Serial.print("Error Distribution: ");
+    Serial.print(F("Error Distribution: "));
     // Show error pattern distribution
     int patternErrors[7] = {0};
-    for (int i = 0; i < errorCount; i++) {
+    for (int i = 0; i < loggedErrors(); i++) {
       if (errorLog[i].pattern < 7) {
         patternErrors[errorLog[i].pattern]++;
       }
@@ -270,230 +287,174 @@ void drawClusterAnalysis() {
     
     for (int p = 0; p < 7; p++) {
       if (patternErrors[p] > 0) {
-        Serial.print("P");
+        Serial.print('P');
         Serial.print(p);
-        Serial.print(":");
+        Serial.print(':');
         Serial.print(patternErrors[p]);
-        Serial.print(" ");
+        Serial.print(' ');
       }
     }
   } else {
-    Serial.print(VT_COLOR_GREEN "All memory cells passed testing!" VT_COLOR_RESET);
+    Serial.print(F(VT_COLOR_GREEN "All memory cells passed testing!" VT_COLOR_RESET));
   }
 }
 
-void runPattern(uint8_t patternID) {
-  // Update status
-  Serial.print("\x1b[4;9H");
-  Serial.print(VT_COLOR_YELLOW "Testing Pattern ");
-  Serial.print(patternID);
-  Serial.print(" ");
-  Serial.print(patternID == 0 ? "(All 0s)" :
-               patternID == 1 ? "(All 1s)" :
-               patternID == 2 ? "(0101...)" :
-               patternID == 3 ? "(0011...)" :
-               patternID == 4 ? "(Row Parity)" :
-               patternID == 5 ? "(Address LSB)" :
-               patternID == 6 ? "(~Address LSB)" : "(Unknown)");
-  Serial.print(VT_COLOR_RESET "                    ");
-
-  int patternErrors = 0;
-  
-  // Writing phase with enhanced visualization
-  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
-    writeBit(addr, patternBit(patternID, addr));
-    
-    if ((addr & 0x7FF) == 0) { // Update every 2048 addresses
-      updateMemoryCell(addr, false, true);
-      refreshIfNeeded();
-      updateProgressBar(addr * 2, totalAddresses * 2, 42, 1); // Double for read+write
-    }
+// Paints the map and status line from the core's pattern runner. The
+// write pass marks the cell under the write cursor; the read pass closes
+// cells in order as it leaves them, painting each by its error counter.
+// Errors arrive in address order, so a cell is final once an address
+// beyond it has been reported.
+class MapFrontEnd : public TestFrontEnd {
+ public:
+  void begin() override {
+    errorCount = 0;
+    clusterCount = 0;
+    initializeDisplay();
   }
 
-  delay(5);
+  void patternStart(uint8_t patternID) override {
+    pattern_ = patternID;
+    Serial.print(F("\x1b[4;9H" VT_COLOR_YELLOW "Testing Pattern "));
+    Serial.print(patternID);
+    Serial.print(F(" ("));
+    Serial.print(patternName(patternID));
+    Serial.print(F(")" VT_COLOR_RESET "                    "));
+  }
 
-  // Reading phase with error detection and visualization
-  for (uint32_t addr = 0; addr < totalAddresses; addr++) {
-    bool expected = patternBit(patternID, addr);
-    bool actual = readBit(addr);
-    bool hasError = (expected != actual);
-    
-    if (hasError) {
-      patternErrors++;
-      logError(addr, patternID, expected, actual);
-      updateMemoryCell(addr, true, false);
+  void phase(bool reading) override {
+    reading_ = reading;
+    nextCell_ = 0;
+    cellErrors_ = 0;
+  }
+
+  void progress(uint32_t done) override {
+    if (reading_) {
+      closeCellsBefore(cellsBelow(done));
     } else {
-      updateMemoryCell(addr, false, false);
+      uint16_t cell = cellOf(done);
+      if (cell != NO_CELL) paintCell(cell, CELL_ACTIVE);
     }
-    
-    if ((addr & 0x7FF) == 0 || addr == totalAddresses - 1) {
-      refreshIfNeeded();
-      updateProgressBar(totalAddresses + addr, totalAddresses * 2, 42, 1);
-      
-      // Update real-time statistics
-      Serial.print("\x1b[4;50H");
-      Serial.print("Errors: ");
-      Serial.print(VT_COLOR_RED);
+    releaseCursor();
+
+    // Two passes per pattern, so each fills half of the bar
+    uint32_t overall = reading_ ? totalAddresses + done : done;
+    updateProgressBar(overall, totalAddresses * 2, progressRow, 1);
+
+    if (reading_) {
+      Serial.beginStatus();
+      Serial.print(F("\x1b[4;50HErrors: " VT_COLOR_RED));
       Serial.print(errorCount);
-      Serial.print(VT_COLOR_RESET);
-      Serial.print(" | Progress: ");
-      Serial.print((totalAddresses + addr) * 100 / (totalAddresses * 2));
-      Serial.print("%    ");
+      Serial.print(F(VT_COLOR_RESET " | Progress: "));
+      Serial.print(overall * 100 / (totalAddresses * 2));
+      Serial.print(F("%    "));
+      Serial.endStatus(done == totalAddresses);
     }
   }
 
-  // Pattern completion status
-  Serial.print("\x1b[4;9H");
-  if (patternErrors == 0) {
-    Serial.print(VT_COLOR_GREEN "Pattern ");
-    Serial.print(patternID);
-    Serial.print(" PASSED" VT_COLOR_RESET "                           ");
-  } else {
-    Serial.print(VT_COLOR_RED "Pattern ");
-    Serial.print(patternID);
-    Serial.print(" FAILED (");
-    Serial.print(patternErrors);
-    Serial.print(" errors)" VT_COLOR_RESET "              ");
+  void error(uint32_t addr, bool expected, bool actual) override {
+    logError(addr, pattern_, expected, actual);
+    uint16_t cell = cellOf(addr);
+    if (cell == NO_CELL) return;
+    closeCellsBefore(cell);
+    // Show a cell as soon as it turns into a cluster
+    if (++cellErrors_ == CLUSTER_THRESHOLD) paintCell(cell, CELL_CLUSTER);
   }
-  
-  delay(100);
-}
 
-void runFullTest() {
-  errorCount = 0;
-  clusterCount = 0;
-  
-  for (uint8_t pattern = 0; pattern <= 6; pattern++) {
-    runPattern(pattern);
-    if (pattern < 6) delay(500); // Brief pause between patterns
-  }
-  
-  detectClusters();
-  drawClusterAnalysis();
-  
-  Serial.print("\x1b[43;1H");
-  Serial.print(VT_BOLD);
-  if (errorCount == 0) {
-    Serial.print(VT_COLOR_GREEN "✓ ALL TESTS COMPLETED SUCCESSFULLY - MEMORY IS HEALTHY");
-  } else if (clusterCount == 0) {
-    Serial.print(VT_COLOR_YELLOW "⚠ TESTS COMPLETED WITH MINOR ERRORS - MONITOR MEMORY");
-  } else {
-    Serial.print(VT_COLOR_RED "✗ TESTS COMPLETED WITH CLUSTER ERRORS - REPLACE MEMORY");
+  void patternEnd(uint8_t patternID, uint32_t errors) override {
+    releaseCursor();
+    Serial.print(F("\x1b[4;9H"));
+    if (errors == 0) {
+      Serial.print(F(VT_COLOR_GREEN "Pattern "));
+      Serial.print(patternID);
+      Serial.print(F(" PASSED" VT_COLOR_RESET "                           "));
+    } else {
+      Serial.print(F(VT_COLOR_RED "Pattern "));
+      Serial.print(patternID);
+      Serial.print(F(" FAILED ("));
+      Serial.print(errors);
+      Serial.print(F(" errors)" VT_COLOR_RESET "              "));
+    }
   }
-  Serial.print(VT_COLOR_RESET);
-}
 
-// Rest of the original functions remain the same...
-void setAddress(uint16_t addr) {
-  for (int i = 0; i < 10; i++) {
-    digitalWrite(addrPins[i], (addr >> i) & 1);
-  }
-}
+  void finish(uint32_t errors) override {
+    detectClusters();
+    drawClusterAnalysis();
 
-void writeBit(uint32_t addr, bool value) {
-  refreshIfNeeded();
-  uint16_t row = (addr >> 8) & 0x1FF;
-  uint16_t col = addr & 0xFF;
-  pinMode(dqPin, OUTPUT);
-  digitalWrite(dqPin, value);
-  setAddress(row);
-  digitalWrite(rasPin, LOW);
-  delayMicroseconds(1);
-  setAddress(col);
-  digitalWrite(casPin, LOW);
-  delayMicroseconds(1);
-  digitalWrite(wePin, LOW);
-  delayMicroseconds(1);
-  digitalWrite(wePin, HIGH);
-  digitalWrite(casPin, HIGH);
-  digitalWrite(rasPin, HIGH);
-  delayMicroseconds(1);
-}
+    vtMoveTo(resultRow, 1);
+    Serial.print(F(VT_BOLD));
+    if (errorCount == 0) {
+      Serial.print(F(VT_COLOR_GREEN "✓ ALL TESTS COMPLETED SUCCESSFULLY - MEMORY IS HEALTHY"));
+    } else if (clusterCount == 0) {
+      Serial.print(F(VT_COLOR_YELLOW "⚠ TESTS COMPLETED WITH MINOR ERRORS - MONITOR MEMORY"));
+    } else {
+      Serial.print(F(VT_COLOR_RED "✗ TESTS COMPLETED WITH CLUSTER ERRORS - REPLACE MEMORY"));
+    }
+    Serial.print(F(VT_COLOR_RESET VT_CURSOR_SHOW));
+  }
 
-bool readBit(uint32_t addr) {
-  refreshIfNeeded();
-  uint16_t row = (addr >> 8) & 0x1FF;
-  uint16_t col = addr & 0xFF;
-  pinMode(dqPin, INPUT);
-  setAddress(row);
-  digitalWrite(rasPin, LOW);
-  delayMicroseconds(1);
-  setAddress(col);
-  digitalWrite(casPin, LOW);
-  delayMicroseconds(1);
-  bool result = digitalRead(dqPin);
-  digitalWrite(casPin, HIGH);
-  digitalWrite(rasPin, HIGH);
-  delayMicroseconds(1);
-  return result;
-}
+ private:
+  uint8_t pattern_ = 0;
+  bool reading_ = false;
+  uint16_t nextCell_ = 0;   // first read-pass cell not yet painted
+  uint16_t cellErrors_ = 0; // errors so far in nextCell_
 
-void refreshIfNeeded() {
-  unsigned long now = micros();
-  if (now - lastRefreshMicros >= refreshInterval) {
-    refreshAllRows();
-    lastRefreshMicros = now;
+  void closeCellsBefore(uint16_t cell) {
+    for (; nextCell_ < cell; nextCell_++) {
+      if (cellErrors_ < CLUSTER_THRESHOLD) {
+        paintCell(nextCell_, cellErrors_ ? CELL_ERROR : CELL_GOOD);
+      }
+      cellErrors_ = 0;
+    }
   }
-}
+};
 
-void refreshAllRows() {
-  for (uint16_t row = 0; row < 256; row++) {
-    setAddress(row);
-    digitalWrite(rasPin, LOW);
-    delayMicroseconds(1);
-    digitalWrite(rasPin, HIGH);
-  }
+MapFrontEnd frontEnd;
+
+void printView() {
+  Serial.print(F("\rView "));
+  Serial.print(geometries[geometryIndex].name);
+  Serial.print(F(", zoom "));
+  Serial.print(zoomLevel);
+  Serial.print(F(": rows "));
+  Serial.print(bandRow);
+  Serial.print('-');
+  Serial.print(bandRow + (windowSize >> colBits) - 1);
+  Serial.print(F(", "));
+  Serial.print(1UL << cellShift);
+  Serial.print(F(" addresses per cell   "));
 }
 
-bool patternBit(uint8_t patternID, uint32_t addr) {
-  switch (patternID) {
-    case 0: return 0;
-    case 1: return 1;
-    case 2: return (addr & 1);
-    case 3: return ((addr >> 1) & 1);
-    case 4: return (addr >> 8) & 1;
-    case 5: return (addr & 0xFFFF) & 1;
-    case 6: return ((~addr) & 0x1FFFF) & 1;
-    default: return 0;
+void chooseView() {
+  applyGeometry();
+  printView();
+
+  unsigned long start = millis();
+  while (millis() - start < 3000) {
+    if (!Serial.available()) continue;
+    char c = Serial.read();
+    uint16_t bandRows = windowSize >> colBits;
+    if (c == '\r' || c == '\n') break;
+    else if (c == 'g') geometryIndex = (geometryIndex + 1) % GEOMETRY_COUNT;
+    else if (c == '+' && zoomLevel < MAX_ZOOM) zoomLevel++;
+    else if (c == '-' && zoomLevel > 0) zoomLevel--;
+    else if (c == '>') bandRow = (bandRow + bandRows) % rowCount;
+    else if (c == '<') bandRow = (bandRow + rowCount - bandRows) % rowCount;
+    else continue;
+    applyGeometry();
+    printView();
+    start = millis();
   }
 }
 
-void updateProgressBar(unsigned long current, unsigned long total, int row, int col) {
-  Serial.print(VT_CURSOR_SAVE);
-  Serial.print("\x1b[");
-  Serial.print(row);
-  Serial.print(";");
-  Serial.print(col);
-  Serial.print("H");
-  
-  int progress = (current * 100) / total;
-  int barLength = 60;
-  int filledLength = (progress * barLength) / 100;
-  
-  Serial.print("Progress: [");
-  Serial.print(VT_COLOR_GREEN);
-  for (int i = 0; i < filledLength; i++) Serial.print("█");
-  Serial.print(VT_COLOR_RESET);
-  for (int i = filledLength; i < barLength; i++) Serial.print("░");
-  Serial.print("] ");
-  Serial.print(progress);
-  Serial.print("%");
-  
-  Serial.print(VT_CURSOR_RESTORE);
-  Serial.flush();
+void setup() {
+  Serial.begin(LINK_BAUD);
+  delay(1000);
+
+  chooseView();
+  setupPins();
+  runAllPatterns(frontEnd, 500);
 }
 
-void printVT100Status(const char* message, int row, int col, const char* color) {
-  Serial.print(VT_CURSOR_SAVE);
-  Serial.print("\x1b[");
-  Serial.print(row);
-  Serial.print(";");
-  Serial.print(col);
-  Serial.print("H");
-  Serial.print(color);
-  Serial.print(message);
-  Serial.print(VT_COLOR_RESET);
-  Serial.print("                             ");
-  Serial.print(VT_CURSOR_RESTORE);
-  Serial.flush();
+void loop() {
+  // Empty - test runs once
 }
@@ -0,0 +1,66 @@
+// chip_profiles.h
+// Geometry and timing of the DRAMs the testers handle. Select one at
+// compile time with -DDRAM_CHIP=CHIP_xxx (or a #define before including
+// this header); everything below is constexpr, so row/column splits and
+// loop bounds reduce to constant shifts and masks for the chosen part.
+//
+// Timings are the datasheet minimums of a common speed grade (-80, or -15
+// for the NMOS parts); check the suffix on the chip in hand.
+
+#pragma once
+
+#include <stdint.h>
+
+#define CHIP_4164      0  // 64K x 1
+#define CHIP_41256     1  // 256K x 1
+#define CHIP_HM511000  2  // 1M x 1
+#define CHIP_514256    3  // 256K x 4
+#define CHIP_MSM514262 4  // 256K x 4 multiport (VRAM)
+
+#ifndef DRAM_CHIP
+#define DRAM_CHIP CHIP_HM511000
+#endif
+
+struct ChipProfile {
+  const char *name;
+  uint8_t rowBits;
+  uint8_t colBits;
+  uint8_t dataWidth;     // DQ lines; the Uno testers wire only DQ1 to PC0
+  uint16_t refreshRows;  // RAS-only cycles per refresh period
+  uint8_t refreshMillis; // refresh period
+  uint8_t tRAC;          // ns, RAS access time
+  uint8_t tCAC;          // ns, CAS access time
+  uint8_t tRP;           // ns, RAS precharge
+  uint8_t tRAS;          // ns, RAS pulse width
+};
+
+constexpr ChipProfile chipProfiles[] = {
+  // name        row col dq  rows  ms  tRAC tCAC tRP tRAS
+  {"4164",        8,  8,  1,  128,  2, 150, 100, 100, 150},
+  {"41256",       9,  9,  1,  256,  4, 150,  75, 100, 150},
+  {"HM511000",   10, 10,  1,  512,  8,  80,  20,  70,  80},
+  {"514256",      9,  9,  4,  512,  8,  80,  20,  60,  80},
+  {"MSM514262",   9,  9,  4,  512,  8,  80,  25,  70,  80},
+};
+
+constexpr ChipProfile chip = chipProfiles[DRAM_CHIP];
+
+constexpr uint8_t rowBits = chip.rowBits;
+constexpr uint8_t colBits = chip.colBits;
+constexpr uint16_t rowCount = 1U << rowBits;
+constexpr uint16_t colCount = 1U << colBits;
+constexpr uint16_t rowMask = rowCount - 1;
+constexpr uint16_t colMask = colCount - 1;
+constexpr uint8_t addressBits = rowBits + colBits;
+constexpr uint32_t totalAddresses = 1UL << addressBits;
+
+// Whole-array refresh period in µs, and the slot one row gets when the
+// refresh is spread evenly over that period
+constexpr unsigned long refreshPeriodMicros = chip.refreshMillis * 1000UL;
+constexpr unsigned long refreshRowMicros = refreshPeriodMicros / chip.refreshRows;
+
+inline uint16_t rowOf(uint32_t addr) { return (addr >> colBits) & rowMask; }
+inline uint16_t colOf(uint32_t addr) { return addr & colMask; }
+inline uint32_t makeAddress(uint16_t row, uint16_t col) {
+  return ((uint32_t)row << colBits) | col;
+}
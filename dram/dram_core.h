@@ -0,0 +1,530 @@
+// dram_core.h
+// Shared tester core for the HM511000 sketches: port mapping, RAS/CAS/WE
+// cycles, refresh, the fixed test patterns and a pattern runner that
+// reports through a pluggable front end (dram_frontend_*.h). Header-only,
+// so every sketch still builds as a single translation unit and a fix here
+// lands in all of them.
+//
+// Wiring is chosen before the include; the default is the Uno layout most
+// sketches use:
+//   DRAM_WIRING_SPLIT  A0–A5 on PD2–PD7 (pins 2–7), A6–A9 on PB0–PB3 (pins 8–11)
+//   DRAM_WIRING_PORTD  A0–A7 on PD0–PD7, A8/A9 on PB2/PB3 (pins 10, 11);
+//                      PB0 stays free for ICP1. The USART owns PD0/PD1
+//                      while it runs, so these sketches call Serial.end()
+//                      before touching the chip and only bring the link
+//                      back up to report
+// DQ, RAS, CAS and WE are on PC0–PC3 (A0–A3) in both, with Din and Dout
+// tied straight to PC0. A rig that adds a series resistor (~330 Ω) on Dout
+// can build with DQ_DOUT_RESISTOR 1 for the single-cycle
+// readModifyWriteBitTimed(); without the resistor that mode drives PC0
+// against Dout, so it stays off by default.
+//
+// Serial output goes through the interrupt-driven queue in dram_serial.h.
+
+#pragma once
+
+#include <Arduino.h>
+#include "chip_profiles.h"
+#include "dram_serial.h"
+
+#define DRAM_WIRING_SPLIT 0
+#define DRAM_WIRING_PORTD 1
+
+#ifndef DRAM_WIRING
+#define DRAM_WIRING DRAM_WIRING_SPLIT
+#endif
+
+#ifndef DQ_DOUT_RESISTOR
+#define DQ_DOUT_RESISTOR 0
+#endif
+
+#define DQ_BIT  0
+#define RAS_BIT 1
+#define CAS_BIT 2
+#define WE_BIT  3
+
+// Port images for an address, for callers that precompute them
+#if DRAM_WIRING == DRAM_WIRING_PORTD
+inline uint8_t addressPortD(uint16_t addr) {
+  return addr & 0xFF;
+}
+
+inline uint8_t addressPortB(uint16_t addr) {
+  return (PORTB & 0xF3) | ((addr >> 6) & 0x0C);
+}
+#else
+inline uint8_t addressPortD(uint16_t addr) {
+  return (PORTD & 0x03) | ((addr << 2) & 0xFC);
+}
+
+inline uint8_t addressPortB(uint16_t addr) {
+  return (PORTB & 0xF0) | ((addr >> 6) & 0x0F);
+}
+#endif
+
+inline void setAddress(uint16_t addr) {
+  PORTD = addressPortD(addr);
+  PORTB = addressPortB(addr);
+}
+
+inline void rasLow() { PORTC &= ~(1 << RAS_BIT); }
+inline void rasHigh() { PORTC |= (1 << RAS_BIT); }
+inline void casLow() { PORTC &= ~(1 << CAS_BIT); }
+inline void casHigh() { PORTC |= (1 << CAS_BIT); }
+inline void weLow() { PORTC &= ~(1 << WE_BIT); }
+inline void weHigh() { PORTC |= (1 << WE_BIT); }
+
+inline void dqInput() { DDRC &= ~(1 << DQ_BIT); }
+
+inline void dqOutput(bool value) {
+  DDRC |= (1 << DQ_BIT);
+  bitWrite(PORTC, DQ_BIT, value);
+}
+
+inline bool dqRead() { return bitRead(PINC, DQ_BIT); }
+
+void setupPins() {
+  // Control lines, inactive high
+  DDRC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
+  PORTC |= (1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT);
+
+#if DRAM_WIRING == DRAM_WIRING_PORTD
+  DDRD = 0xFF;        // A0–A7
+  DDRB |= 0x0C;       // A8, A9
+#else
+  DDRD |= 0xFC;       // A0–A5 (PD0/PD1 stay with Serial)
+  DDRB |= 0x0F;       // A6–A9
+#endif
+
+  DDRC |= (1 << DQ_BIT); // Default DQ output
+
+  // Timer1 free-running at 16 MHz for cycle timing
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);
+}
+
+// Every chip line driven low, so an unpowered chip can be swapped
+// without being back-fed through its inputs
+void parkPins() {
+  PORTC &= ~((1 << RAS_BIT) | (1 << CAS_BIT) | (1 << WE_BIT) | (1 << DQ_BIT));
+  DDRC |= (1 << DQ_BIT);
+#if DRAM_WIRING == DRAM_WIRING_PORTD
+  PORTD = 0;
+  PORTB &= 0xF3;
+#else
+  PORTD &= 0x03;
+  PORTB &= 0xF0;
+#endif
+}
+
+// Refresh strategies. The testers use REFRESH_BURST; the others exist so
+// 511000_refresh_bench.ino can measure what they cost.
+//   REFRESH_BURST        every row, RAS-only, each half refresh period,
+//                        leaving the other half as slack for the access
+//                        that is in flight when it is due
+//   REFRESH_DISTRIBUTED  one RAS-only row per refreshRowMicros slot
+//   REFRESH_CBR          one CAS-before-RAS cycle per slot; the chip's own
+//                        counter picks the row, the address lines are idle
+//   REFRESH_HIDDEN       due slots ride on reads: CAS stays low after the
+//                        data is sampled and RAS is cycled again, a CBR
+//                        cycle with the output held. One per read at
+//                        most; any further backlog, writes, page-mode
+//                        reads and idle waits fall back to plain CBR.
+enum RefreshMode : uint8_t {
+  REFRESH_BURST,
+  REFRESH_DISTRIBUTED,
+  REFRESH_CBR,
+  REFRESH_HIDDEN,
+};
+const uint8_t REFRESH_MODE_COUNT = 4;
+
+RefreshMode refreshMode = REFRESH_BURST;
+const unsigned long refreshInterval = refreshPeriodMicros / 2; // µs
+unsigned long lastRefreshMicros = 0;
+uint16_t nextRefreshRow = 0;   // REFRESH_DISTRIBUTED
+uint32_t refreshCycles = 0;    // refresh cycles issued, for benchmarks
+
+const char *refreshModeName(uint8_t mode) {
+  switch (mode) {
+    case REFRESH_BURST: return "Burst";
+    case REFRESH_DISTRIBUTED: return "Distributed";
+    case REFRESH_CBR: return "CBR";
+    case REFRESH_HIDDEN: return "Hidden";
+    default: return "Unknown";
+  }
+}
+
+inline void rasOnlyRefresh(uint16_t row) {
+  setAddress(row);
+  rasLow();
+  delayMicroseconds(1);
+  rasHigh();
+  refreshCycles++;
+}
+
+inline void cbrRefresh() {
+  casLow();
+  rasLow();
+  delayMicroseconds(1);
+  rasHigh();
+  casHigh();
+  refreshCycles++;
+}
+
+void refreshAllRows() {
+  for (uint16_t row = 0; row < chip.refreshRows; row++) rasOnlyRefresh(row);
+}
+
+// True once per elapsed refreshRowMicros slot. The schedule advances by
+// whole slots, so the average rate holds despite micros() moving in 4 µs
+// steps; after a stall longer than a refresh period no more than one full
+// refresh is owed.
+bool refreshSlotDue() {
+  unsigned long late = micros() - lastRefreshMicros;
+  if (late < refreshRowMicros) return false;
+  if (late > refreshPeriodMicros) lastRefreshMicros += late - refreshPeriodMicros;
+  lastRefreshMicros += refreshRowMicros;
+  return true;
+}
+
+void refreshIfNeeded() {
+  switch (refreshMode) {
+    case REFRESH_BURST: {
+      unsigned long now = micros();
+      if (now - lastRefreshMicros >= refreshInterval) {
+        refreshAllRows();
+        lastRefreshMicros = now;
+      }
+      break;
+    }
+    case REFRESH_DISTRIBUTED:
+      while (refreshSlotDue()) {
+        rasOnlyRefresh(nextRefreshRow);
+        if (++nextRefreshRow == chip.refreshRows) nextRefreshRow = 0;
+      }
+      break;
+    default:
+      while (refreshSlotDue()) cbrRefresh();
+      break;
+  }
+}
+
+// Switches strategy on a freshly refreshed array, so no row is owed
+// across the change
+void setRefreshMode(RefreshMode mode) {
+  refreshAllRows();
+  lastRefreshMicros = micros();
+  nextRefreshRow = 0;
+  refreshMode = mode;
+}
+
+// Timer1 free-runs at 16 MHz (see setupPins()), so the *Timed() cycles
+// report in 62.5 ns ticks. One access is far shorter than the 4.1 ms wrap.
+unsigned long writeBitTimed(uint32_t addr, bool value) {
+  refreshIfNeeded();
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+
+  dqOutput(value);
+
+  uint16_t t0 = TCNT1;
+
+  setAddress(row);
+  rasLow();
+  delayMicroseconds(1);
+
+  setAddress(col);
+  casLow();
+  delayMicroseconds(1);
+
+  weLow();
+  delayMicroseconds(1);
+
+  weHigh();
+  casHigh();
+  rasHigh();
+
+  return (uint16_t)(TCNT1 - t0);
+}
+
+unsigned long readBitTimed(uint32_t addr, bool &result) {
+  bool hidden = refreshMode == REFRESH_HIDDEN;
+  if (!hidden) refreshIfNeeded();
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+
+  dqInput();
+  uint16_t t0 = TCNT1;
+  setAddress(row);
+  rasLow();
+  delayMicroseconds(1);
+
+  setAddress(col);
+  casLow();
+  delayMicroseconds(1);
+
+  result = dqRead();
+  uint16_t t1 = TCNT1;
+
+  // Hidden refresh: RAS high then low under the held CAS, once, so CAS is
+  // never held low across a backlog
+  bool refreshed = hidden && refreshSlotDue();
+  if (refreshed) {
+    rasHigh();
+    rasLow();
+    delayMicroseconds(1);
+    refreshCycles++;
+  }
+
+  casHigh();
+  rasHigh();
+
+  if (refreshed) refreshIfNeeded(); // slots still owed go out as plain CBR
+
+  return (uint16_t)(t1 - t0);
+}
+
+// Read-modify-write: the stored bit is sampled with WE high, then DQ is
+// turned around and a late WE strobe writes `value` into the same open
+// column, so a read/write pair costs one RAS/CAS cycle instead of two.
+// Dout stays enabled until CAS rises, so for the WE pulse the MCU drives
+// PC0 against it; the series resistor on Dout limits that to a few mA.
+// With DQ_DOUT_RESISTOR 0 the pair is a read cycle and an early-write
+// cycle instead, which never overlaps the two drivers.
+unsigned long readModifyWriteBitTimed(uint32_t addr, bool value, bool &result) {
+#if !DQ_DOUT_RESISTOR
+  unsigned long t = readBitTimed(addr, result);
+  return t + writeBitTimed(addr, value);
+#else
+  refreshIfNeeded();
+  uint16_t row = rowOf(addr);
+  uint16_t col = colOf(addr);
+
+  dqInput();
+  uint16_t t0 = TCNT1;
+  setAddress(row);
+  rasLow();
+  delayMicroseconds(1);
+
+  setAddress(col);
+  casLow();
+  delayMicroseconds(1);
+
+  result = dqRead();
+
+  dqOutput(value);
+  weLow();             // late write
+  delayMicroseconds(1);
+
+  weHigh();
+  casHigh();
+  rasHigh();
+
+  return (uint16_t)(TCNT1 - t0);
+#endif
+}
+
+inline void writeBit(uint32_t addr, bool value) {
+  writeBitTimed(addr, value);
+}
+
+inline bool readBit(uint32_t addr) {
+  bool result;
+  readBitTimed(addr, result);
+  return result;
+}
+
+inline bool readModifyWriteBit(uint32_t addr, bool value) {
+  bool result;
+  readModifyWriteBitTimed(addr, value, result);
+  return result;
+}
+
+// Fast page mode: RAS stays low over several CAS cycles, so the row
+// address goes out once per burst instead of once per bit. Bit i of a
+// page byte is column col + i; col is a multiple of PAGE_COLUMNS.
+//
+// Only A0–A2 change within a page, and they are on PORTD in both wirings,
+// so the column images are computed before RAS falls and a burst is just
+// stores and CAS strobes, run with interrupts off. Counted from the
+// instruction sequence, a column takes about 15 cycles to write and
+// 16 + casAccessCycles to read; a page is two bursts of PAGE_BURST
+// columns, which keeps each RAS low time near 5 µs, well inside the
+// 10 µs tRAS maximum of these parts.
+const uint8_t PAGE_COLUMNS = 8;
+const uint8_t PAGE_BURST = 4;
+
+// Cycles from CAS falling to a valid PINC sample: tCAC rounded up to
+// 62.5 ns cycles, plus one for the input synchronizer
+constexpr uint8_t casAccessCycles = (chip.tCAC * 16 + 999) / 1000 + 1;
+
+void writePage(uint16_t row, uint16_t col, uint8_t bits) {
+  refreshIfNeeded();
+  uint8_t rowD = addressPortD(row), rowB = addressPortB(row);
+  uint8_t colB = addressPortB(col);
+  uint8_t colD[PAGE_COLUMNS];
+  for (uint8_t i = 0; i < PAGE_COLUMNS; i++) colD[i] = addressPortD(col + i);
+
+  DDRC |= (1 << DQ_BIT);
+  for (uint8_t i = 0; i < PAGE_COLUMNS; i += PAGE_BURST) {
+    uint8_t oldSREG = SREG;
+    cli();
+    PORTD = rowD;
+    PORTB = rowB;
+    rasLow();
+    weLow();             // early write: DQ is latched as CAS falls
+    PORTB = colB;
+
+    uint8_t portC = PORTC & ~(1 << DQ_BIT);
+    for (uint8_t j = i; j < i + PAGE_BURST; j++) {
+      PORTD = colD[j];
+      PORTC = portC | ((bits & 1) << DQ_BIT);
+      casLow();
+      casHigh();
+      bits >>= 1;
+    }
+
+    weHigh();
+    rasHigh();
+    SREG = oldSREG;
+  }
+}
+
+uint8_t readPage(uint16_t row, uint16_t col) {
+  refreshIfNeeded();
+  uint8_t rowD = addressPortD(row), rowB = addressPortB(row);
+  uint8_t colB = addressPortB(col);
+  uint8_t colD[PAGE_COLUMNS];
+  for (uint8_t i = 0; i < PAGE_COLUMNS; i++) colD[i] = addressPortD(col + i);
+
+  dqInput();
+  uint8_t bits = 0;
+  for (uint8_t i = 0; i < PAGE_COLUMNS; i += PAGE_BURST) {
+    uint8_t oldSREG = SREG;
+    cli();
+    PORTD = rowD;
+    PORTB = rowB;
+    rasLow();
+    PORTB = colB;
+
+    for (uint8_t j = i; j < i + PAGE_BURST; j++) {
+      PORTD = colD[j];
+      casLow();
+      __builtin_avr_delay_cycles(casAccessCycles);
+      bits >>= 1;
+      if (dqRead()) bits |= 0x80;
+      casHigh();
+    }
+
+    rasHigh();
+    SREG = oldSREG;
+  }
+  return bits;
+}
+
+// Fixed data patterns
+const uint8_t PATTERN_COUNT = 7;
+
+bool patternBit(uint8_t patternID, uint32_t addr) {
+  switch (patternID) {
+    case 0: return 0;                     // All 0s
+    case 1: return 1;                     // All 1s
+    case 2: return addr & 1;              // 0101...
+    case 3: return (addr >> 1) & 1;       // 0011...
+    case 4: return (addr >> colBits) & 1; // row parity
+    case 5: return addr & 0xFFFF & 1;     // address LSB
+    case 6: return (~addr) & 1;           // inverse address LSB
+    default: return 0;
+  }
+}
+
+const char *patternName(uint8_t patternID) {
+  switch (patternID) {
+    case 0: return "All 0s";
+    case 1: return "All 1s";
+    case 2: return "0101...";
+    case 3: return "0011...";
+    case 4: return "Row Parity";
+    case 5: return "Address LSB";
+    case 6: return "~Address LSB";
+    default: return "Unknown";
+  }
+}
+
+// Expected bits of PAGE_COLUMNS consecutive addresses in `row`, bit i for
+// column i. Every fixed pattern depends on the row and the two lowest
+// column bits only, so this one byte holds for the whole row and the
+// runner compares a page at a time instead of calling patternBit() per
+// address.
+uint8_t patternByte(uint8_t patternID, uint16_t row) {
+  uint8_t bits = 0;
+  for (uint8_t i = 0; i < PAGE_COLUMNS; i++)
+    if (patternBit(patternID, makeAddress(row, i))) bits |= 1 << i;
+  return bits;
+}
+
+// What a sketch shows while runPattern() works. Every hook is optional;
+// progress() is called every PROGRESS_STEP addresses and once at the end
+// of each phase.
+class TestFrontEnd {
+ public:
+  virtual void begin() {}
+  virtual void patternStart(uint8_t patternID) {}
+  virtual void phase(bool reading) {}
+  virtual void progress(uint32_t done) {}
+  virtual void error(uint32_t addr, bool expected, bool actual) {}
+  virtual void patternEnd(uint8_t patternID, uint32_t errors) {}
+  virtual void finish(uint32_t errors) {}
+};
+
+const uint32_t PROGRESS_STEP = 0x1000;
+
+// Rows go out in page mode and come back as whole bytes; only a page
+// that differs from its pattern byte is taken apart for error reports.
+uint32_t runPattern(uint8_t patternID, TestFrontEnd &ui) {
+  uint32_t errors = 0;
+  ui.patternStart(patternID);
+
+  ui.phase(false);
+  for (uint16_t row = 0; row < rowCount; row++) {
+    uint32_t addr = makeAddress(row, 0);
+    if ((addr & (PROGRESS_STEP - 1)) == 0) ui.progress(addr);
+    uint8_t expected = patternByte(patternID, row);
+    for (uint16_t col = 0; col < colCount; col += PAGE_COLUMNS)
+      writePage(row, col, expected);
+  }
+  ui.progress(totalAddresses);
+
+  ui.phase(true);
+  for (uint16_t row = 0; row < rowCount; row++) {
+    uint32_t addr = makeAddress(row, 0);
+    if ((addr & (PROGRESS_STEP - 1)) == 0) ui.progress(addr);
+    uint8_t expected = patternByte(patternID, row);
+    for (uint16_t col = 0; col < colCount; col += PAGE_COLUMNS) {
+      uint8_t wrong = readPage(row, col) ^ expected;
+      for (uint8_t i = 0; wrong; i++, wrong >>= 1) {
+        if (!(wrong & 1)) continue;
+        bool bit = (expected >> i) & 1;
+        errors++;
+        ui.error(addr + col + i, bit, !bit);
+      }
+    }
+  }
+  ui.progress(totalAddresses);
+
+  ui.patternEnd(patternID, errors);
+  return errors;
+}
+
+// All fixed patterns with a refreshed pause between them
+uint32_t runAllPatterns(TestFrontEnd &ui, unsigned long pauseMillis) {
+  uint32_t errors = 0;
+  ui.begin();
+  for (uint8_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    errors += runPattern(pattern, ui);
+    unsigned long start = millis();
+    while (millis() - start < pauseMillis) refreshIfNeeded();
+  }
+  ui.finish(errors);
+  return errors;
+}
@@ -0,0 +1,68 @@
+// dram_frontend_binary.h
+// Compact records for host tools, sent as CRC frames (see dram_serial.h)
+// with little-endian payloads:
+//   'B'                    run started
+//   'P' pattern            pattern started
+//   'W' / 'R'              write / read phase started
+//   'G' done(4)            addresses done in the current phase
+//   'E' addr(4) actual(1)  read-back mismatch
+//   'C' pattern errors(4)  pattern finished
+//   'D' errors(4)          run finished
+// Progress is sent every PROGRESS_BINARY_STEP addresses rather than every
+// PROGRESS_STEP, which keeps the link mostly idle during clean passes, and
+// as a status record, so it is skipped while errors back the link up.
+
+#pragma once
+
+#include "dram_core.h"
+
+const uint32_t PROGRESS_BINARY_STEP = 0x10000;
+
+class BinaryFrontEnd : public TestFrontEnd {
+ public:
+  void begin() override { record('B', 0); }
+
+  void patternStart(uint8_t patternID) override {
+    payload_[0] = patternID;
+    record('P', 1);
+  }
+
+  void phase(bool reading) override { record(reading ? 'R' : 'W', 0); }
+
+  void progress(uint32_t done) override {
+    bool last = done == totalAddresses;
+    if ((done & (PROGRESS_BINARY_STEP - 1)) && !last) return;
+    put32(0, done);
+    Serial.beginStatus();
+    record('G', 4);
+    Serial.endStatus(last);
+  }
+
+  void error(uint32_t addr, bool expected, bool actual) override {
+    put32(0, addr);
+    payload_[4] = actual;
+    record('E', 5);
+  }
+
+  void patternEnd(uint8_t patternID, uint32_t errors) override {
+    payload_[0] = patternID;
+    put32(1, errors);
+    record('C', 5);
+  }
+
+  void finish(uint32_t errors) override {
+    put32(0, errors);
+    record('D', 4);
+  }
+
+ private:
+  uint8_t payload_[5];
+
+  void put32(uint8_t at, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) payload_[at + i] = value >> (8 * i);
+  }
+
+  void record(char type, uint8_t len) {
+    Serial.sendFrame(type, payload_, len);
+  }
+};
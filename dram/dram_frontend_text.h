@@ -0,0 +1,35 @@
+// dram_frontend_text.h
+// Plain line-per-event output for any serial monitor.
+
+#pragma once
+
+#include "dram_core.h"
+
+class TextFrontEnd : public TestFrontEnd {
+ public:
+  void patternStart(uint8_t patternID) override {
+    Serial.print(F("Testing pattern "));
+    Serial.print(patternID);
+    Serial.print(F(": "));
+    Serial.println(patternName(patternID));
+  }
+
+  void error(uint32_t addr, bool expected, bool actual) override {
+    Serial.print(F("Error at addr 0x"));
+    Serial.print(addr, HEX);
+    Serial.print(F(": expected "));
+    Serial.print(expected);
+    Serial.print(F(", got "));
+    Serial.println(actual);
+  }
+
+  void patternEnd(uint8_t patternID, uint32_t errors) override {
+    Serial.print(F("Pattern complete, errors: "));
+    Serial.println(errors);
+  }
+
+  void finish(uint32_t errors) override {
+    Serial.print(F("All tests complete, errors: "));
+    Serial.println(errors);
+  }
+};
@@ -0,0 +1,141 @@
+// dram_frontend_vt100.h
+// VT100 escape codes and helpers, and a front end with a status line,
+// progress bar and running error count.
+
+#pragma once
+
+#include "dram_core.h"
+
+#define VT_CLEAR_SCREEN "\x1b[2J"
+#define VT_CURSOR_HOME "\x1b[H"
+#define VT_COLOR_RED "\x1b[31m"
+#define VT_COLOR_GREEN "\x1b[32m"
+#define VT_COLOR_YELLOW "\x1b[33m"
+#define VT_COLOR_BLUE "\x1b[34m"
+#define VT_COLOR_MAGENTA "\x1b[35m"
+#define VT_COLOR_CYAN "\x1b[36m"
+#define VT_COLOR_WHITE "\x1b[37m"
+#define VT_COLOR_RESET "\x1b[0m"
+#define VT_CURSOR_SAVE "\x1b[s"
+#define VT_CURSOR_RESTORE "\x1b[u"
+#define VT_CURSOR_HIDE "\x1b[?25l"
+#define VT_CURSOR_SHOW "\x1b[?25h"
+#define VT_BOLD "\x1b[1m"
+#define VT_DIM "\x1b[2m"
+#define VT_BLINK "\x1b[5m"
+#define VT_REVERSE "\x1b[7m"
+#define VT_BG_RED "\x1b[41m"
+#define VT_BG_GREEN "\x1b[42m"
+#define VT_BG_YELLOW "\x1b[43m"
+
+void vtMoveTo(int row, int col) {
+  Serial.print(F("\x1b["));
+  Serial.print(row);
+  Serial.print(';');
+  Serial.print(col);
+  Serial.print('H');
+}
+
+// Message at row/col in the given colour, clearing the rest of the field
+void printVT100Status(const char *message, int row, int col, const char *color) {
+  Serial.print(F(VT_CURSOR_SAVE));
+  vtMoveTo(row, col);
+  Serial.print(color);
+  Serial.print(message);
+  Serial.print(F(VT_COLOR_RESET "                             "));
+  Serial.print(F(VT_CURSOR_RESTORE));
+}
+
+// Sent as a status record (dram_serial.h): intermediate updates are
+// dropped while the link is backed up, the final one always goes out
+void updateProgressBar(unsigned long current, unsigned long total, int row, int col) {
+  const int barLength = 50;
+  int progress = (current * 100) / total;
+  int filledLength = (progress * barLength) / 100;
+
+  Serial.beginStatus();
+  Serial.print(F(VT_CURSOR_SAVE));
+  vtMoveTo(row, col);
+  Serial.print('[');
+  for (int i = 0; i < filledLength; i++) Serial.print('#');
+  for (int i = filledLength; i < barLength; i++) Serial.print('-');
+  Serial.print(F("] "));
+  Serial.print(progress);
+  Serial.print(F("% ("));
+  Serial.print(current);
+  Serial.print('/');
+  Serial.print(total);
+  Serial.print(')');
+  Serial.print(F(VT_CURSOR_RESTORE));
+  Serial.endStatus(current == total);
+}
+
+// Screen layout: title on rows 1–2, pattern on 3, phase on 5, progress on
+// 6, error count on 8, last error on 9, final result on 10.
+class Vt100FrontEnd : public TestFrontEnd {
+ public:
+  void begin() override {
+    Serial.print(F(VT_CLEAR_SCREEN VT_CURSOR_HOME VT_CURSOR_HIDE));
+    Serial.print(F("DRAM Test with Auto-Refresh, "));
+    Serial.println(chip.name);
+    Serial.println(F("---------------------------"));
+  }
+
+  void patternStart(uint8_t patternID) override {
+    errors_ = 0;
+    vtMoveTo(3, 0);
+    Serial.print(F("Testing pattern "));
+    Serial.print(patternID);
+    Serial.print(F(": "));
+    Serial.print(patternName(patternID));
+    Serial.print(F(VT_COLOR_RESET "                "));
+    showErrors();
+  }
+
+  void phase(bool reading) override {
+    printVT100Status(reading ? "Reading..." : "Writing...", 5, 0, VT_COLOR_YELLOW);
+  }
+
+  void progress(uint32_t done) override {
+    updateProgressBar(done, totalAddresses, 6, 0);
+  }
+
+  void error(uint32_t addr, bool expected, bool actual) override {
+    errors_++;
+    Serial.print(F(VT_CURSOR_SAVE));
+    vtMoveTo(9, 0);
+    Serial.print(F(VT_COLOR_RED "Error at addr 0x"));
+    Serial.print(addr, HEX);
+    Serial.print(F(": expected "));
+    Serial.print(expected);
+    Serial.print(F(", got "));
+    Serial.print(actual);
+    Serial.print(F(VT_COLOR_RESET VT_CURSOR_RESTORE));
+    showErrors();
+  }
+
+  void patternEnd(uint8_t patternID, uint32_t errors) override {
+    if (errors == 0) printVT100Status("Pattern Complete: PASSED", 5, 0, VT_COLOR_GREEN);
+    else printVT100Status("Pattern Complete: FAILED", 5, 0, VT_COLOR_RED);
+    vtMoveTo(7, 0);
+    Serial.print(F("------------------------------------------------"));
+  }
+
+  void finish(uint32_t errors) override {
+    vtMoveTo(10, 0);
+    Serial.print(errors ? F(VT_COLOR_RED) : F(VT_COLOR_GREEN));
+    Serial.print(F("All tests complete, errors: "));
+    Serial.print(errors);
+    Serial.println(F(VT_COLOR_RESET VT_CURSOR_SHOW));
+  }
+
+ private:
+  uint32_t errors_ = 0;
+
+  void showErrors() {
+    vtMoveTo(8, 0);
+    Serial.print(F("Errors: "));
+    Serial.print(errors_);
+    Serial.print(F("        "));
+  }
+};
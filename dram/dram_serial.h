@@ -0,0 +1,257 @@
+// dram_serial.h
+// Tester-owned USART0 driver. Output goes into a RAM ring drained by the
+// UDRE interrupt, so a test loop only ever waits on the UART when the ring
+// is full. Included by dram_core.h; from there on `Serial` names this
+// driver. HardwareSerial is then never referenced, its USART interrupt
+// handlers are not linked and the ones below take their vectors.
+//
+// Ordinary output is queued in order. A writer that finds the ring full
+// keeps the array refreshed while it waits, so error reports are delayed
+// rather than lost and the chip's data survives the wait.
+//
+// Status output (progress bars, running counts) goes between
+// beginStatus() and endStatus(). It is staged and enters the ring in one
+// piece, and it is dropped rather than waited for when the ring is short
+// of room or the previous status record has not gone out yet: the next
+// update supersedes it anyway, so the link never falls behind on stale
+// state. Use endStatus(true) for a final state that must be shown.
+//
+// Binary records go out as CRC frames via sendFrame():
+//   A5 <type> <len> <payload...> <crc lo> <crc hi>
+// The CRC is CRC-16/XMODEM over type, len and payload. With LINK_FRAMED
+// set, text is wrapped as well, in 'T' frames of up to LINE_SIZE bytes cut
+// at newlines. That is what makes 1–2 Mbaud usable, where a dropped or
+// corrupted byte then costs one frame instead of garbling the log;
+// host/salvage_log.py finds the rate and the framing by itself. Select
+// before including dram_core.h, e.g.
+//   #define LINK_BAUD 1000000
+//   #define LINK_FRAMED 1
+// The 16U2 USB bridge on the Uno carries 1 and 2 Mbaud; at 16 MHz both
+// divide exactly in double speed mode.
+
+#pragma once
+
+#ifndef LINK_BAUD
+#define LINK_BAUD 115200
+#endif
+#ifndef LINK_FRAMED
+#define LINK_FRAMED 0
+#endif
+
+const uint8_t FRAME_SYNC = 0xA5;
+const uint8_t FRAME_TEXT = 'T';
+
+#ifdef __AVR__
+
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+
+#ifndef TX_RING_SIZE
+#define TX_RING_SIZE 256 // power of two, at most 256
+#endif
+#ifndef STATUS_SIZE
+#define STATUS_SIZE 112  // longest status record, framed
+#endif
+#define LINE_SIZE 64
+#define RX_RING_SIZE 16
+
+void refreshIfNeeded();
+
+class TesterSerial : public Print {
+ public:
+  void begin(unsigned long baud) {
+    // Double speed mode, as the Arduino core uses for standard rates
+    UCSR0A = 1 << U2X0;
+    UBRR0 = (F_CPU / 4 / baud - 1) / 2;
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // 8N1
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+  }
+
+  int available() {
+    return (uint8_t)(rxHead_ - rxTail_) & (RX_RING_SIZE - 1);
+  }
+
+  int read() {
+    if (rxHead_ == rxTail_) return -1;
+    uint8_t c = rxBuf_[rxTail_];
+    rxTail_ = (rxTail_ + 1) & (RX_RING_SIZE - 1);
+    return c;
+  }
+
+  size_t write(uint8_t c) override {
+#if LINK_FRAMED
+    lineBuf_[lineLen_++] = c;
+    if (c == '\n' || lineLen_ == LINE_SIZE) flushLine();
+#else
+    put(c);
+#endif
+    return 1;
+  }
+  using Print::write;
+
+  void sendFrame(uint8_t type, const uint8_t *payload, uint8_t len) {
+    flushLine();
+    uint16_t crc = _crc_xmodem_update(0, type);
+    crc = _crc_xmodem_update(crc, len);
+    for (uint8_t i = 0; i < len; i++) crc = _crc_xmodem_update(crc, payload[i]);
+
+    put(FRAME_SYNC);
+    put(type);
+    put(len);
+    for (uint8_t i = 0; i < len; i++) put(payload[i]);
+    put(crc & 0xFF);
+    put(crc >> 8);
+  }
+
+  int availableForWrite() override {
+    return TX_RING_SIZE - 1 - queued();
+  }
+
+  // Waits until everything queued has left the shift register
+  void flush() override {
+    flushLine();
+    if (!written_) return;
+    while (queued() || !(UCSR0A & (1 << TXC0))) pollIfMasked();
+  }
+
+  // Drains the queue and hands PD0/PD1 back to PORTD/DDRD
+  void end() {
+    flush();
+    UCSR0B = 0;
+  }
+
+  void beginStatus() {
+    flushLine();
+    staging_ = true;
+    statusLen_ = 0;
+    statusOverflow_ = false;
+  }
+
+  // Returns false when the record was dropped
+  bool endStatus(bool force = false) {
+    flushLine();
+    staging_ = false;
+    if (statusOverflow_) return false;
+
+    if (!force) {
+      uint16_t sent;
+      uint8_t oldSREG = SREG;
+      cli();
+      sent = sentCount_;
+      SREG = oldSREG;
+      bool previousPending = (int16_t)(statusEndCount_ - sent) > 0;
+      if (previousPending || availableForWrite() < statusLen_) {
+        statusDropped++;
+        return false;
+      }
+    }
+
+    waitForRoom(statusLen_);
+    for (uint8_t i = 0; i < statusLen_; i++) enqueue(statusBuf_[i]);
+    statusEndCount_ = queuedCount_;
+    UCSR0B |= (1 << UDRIE0);
+    return true;
+  }
+
+  operator bool() { return true; }
+
+  // Interrupt side
+  void txReady() {
+    if (txHead_ == txTail_) {
+      UCSR0B &= ~(1 << UDRIE0);
+      return;
+    }
+    UDR0 = txBuf_[txTail_];
+    txTail_ = (txTail_ + 1) & (TX_RING_SIZE - 1);
+    sentCount_++;
+    // Clear TXC so flush() sees the last byte leave the shift register
+    UCSR0A = (UCSR0A & (1 << U2X0)) | (1 << TXC0);
+  }
+
+  void rxReady() {
+    uint8_t c = UDR0;
+    uint8_t next = (rxHead_ + 1) & (RX_RING_SIZE - 1);
+    if (next == rxTail_) return; // full: drop
+    rxBuf_[rxHead_] = c;
+    rxHead_ = next;
+  }
+
+  uint16_t statusDropped = 0;
+
+ private:
+  uint8_t txBuf_[TX_RING_SIZE];
+  volatile uint8_t txHead_ = 0;
+  volatile uint8_t txTail_ = 0;
+  uint16_t queuedCount_ = 0;        // bytes ever queued, wrapping
+  volatile uint16_t sentCount_ = 0; // bytes ever sent, wrapping
+  uint16_t statusEndCount_ = 0;     // queuedCount_ after the last status
+  bool written_ = false;
+
+  uint8_t statusBuf_[STATUS_SIZE];
+  uint8_t statusLen_ = 0;
+  bool staging_ = false;
+  bool statusOverflow_ = false;
+
+#if LINK_FRAMED
+  uint8_t lineBuf_[LINE_SIZE];
+  uint8_t lineLen_ = 0;
+#endif
+
+  uint8_t rxBuf_[RX_RING_SIZE];
+  volatile uint8_t rxHead_ = 0;
+  volatile uint8_t rxTail_ = 0;
+
+  // Raw byte into the status staging buffer or the ring
+  void put(uint8_t c) {
+    if (staging_) {
+      if (statusLen_ < STATUS_SIZE) statusBuf_[statusLen_++] = c;
+      else statusOverflow_ = true;
+      return;
+    }
+    waitForRoom(1);
+    enqueue(c);
+    UCSR0B |= (1 << UDRIE0);
+  }
+
+  void flushLine() {
+#if LINK_FRAMED
+    uint8_t len = lineLen_;
+    if (!len) return;
+    lineLen_ = 0;
+    sendFrame(FRAME_TEXT, lineBuf_, len);
+#endif
+  }
+
+  uint8_t queued() {
+    return (uint8_t)(txHead_ - txTail_) & (TX_RING_SIZE - 1);
+  }
+
+  void enqueue(uint8_t c) {
+    txBuf_[txHead_] = c;
+    txHead_ = (txHead_ + 1) & (TX_RING_SIZE - 1);
+    queuedCount_++;
+    written_ = true;
+  }
+
+  // With interrupts masked the UDRE handler cannot run, so feed the
+  // UART from here instead
+  void pollIfMasked() {
+    if (!(SREG & (1 << SREG_I)) && (UCSR0A & (1 << UDRE0))) txReady();
+  }
+
+  void waitForRoom(uint8_t n) {
+    while (availableForWrite() < n) {
+      pollIfMasked();
+      refreshIfNeeded();
+    }
+  }
+};
+
+TesterSerial testerSerial;
+
+ISR(USART_UDRE_vect) { testerSerial.txReady(); }
+ISR(USART_RX_vect) { testerSerial.rxReady(); }
+
+#define Serial testerSerial
+
+#endif // __AVR__
@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+# salvage_log.py
+# Host side of the 511000_opt.ino batch mode. Opens the tester's serial
+# port, switches it into batch mode and appends one record per chip to an
+# SQLite database or a CSV file. Everything the tester prints is echoed so
+# the operator can follow the run; pressing Enter triggers the next chip
+# like the button does.
+#
+# Usage: salvage_log.py /dev/ttyUSB0 [--lot NAME] [--baud N] [--db chips.sqlite | --csv chips.csv]
+#
+# Without --baud the link rate is found by trying each of BAUD_RATES until
+# the tester's banner arrives as clean text or as valid CRC frames (the
+# LINK_BAUD / LINK_FRAMED build options in ../dram_serial.h).
+#
+# Only the standard library is used (termios for the port), so it runs on
+# any Linux or macOS box without pyserial. Rates above 230400 need Linux.
+
+import argparse
+import csv
+import os
+import select
+import sqlite3
+import sys
+import termios
+import time
+
+FIELDS = ["seq", "chip", "class", "errors", "first_fail", "failed_steps",
+          "retention_ms", "cac_sweep", "rcd_sweep", "seconds"]
+MAX_FAIL_LINES = 200  # failure-map lines kept per chip
+
+BAUD_RATES = [2000000, 1000000, 500000, 115200]
+DETECT_SECONDS = 2.5  # reset, bootloader and banner
+
+FRAME_SYNC = 0xA5
+FRAME_TEXT = ord("T")
+
+
+def crc_xmodem(data, crc=0):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+class FrameDecoder:
+    """Splits the byte stream into text and CRC frames (see dram_serial.h).
+
+    A sync byte only starts a frame if the whole frame checks out. Until
+    the first good frame everything else is passed through as text, so
+    plain 115200 text works unchanged; after it, bytes outside frames are
+    line noise and dropped. Text frames are unwrapped into the text
+    stream."""
+
+    def __init__(self):
+        self.pending = b""
+        self.frames = 0
+        self.bad = 0
+
+    def feed(self, data):
+        """Returns (text bytes, [(type, payload)]) for the data so far."""
+        self.pending += data
+        text = bytearray()
+        frames = []
+        buf = self.pending
+        i = 0
+        while i < len(buf):
+            if buf[i] != FRAME_SYNC:
+                if not self.frames:
+                    text.append(buf[i])
+                i += 1
+                continue
+            if len(buf) - i < 3:
+                break  # header incomplete
+            length = buf[i + 2]
+            end = i + 3 + length + 2
+            if end > len(buf):
+                break  # wait for the rest
+            body = buf[i + 1:i + 3 + length]
+            crc = buf[end - 2] | buf[end - 1] << 8
+            if crc_xmodem(body) != crc:
+                self.bad += 1
+                if not self.frames:
+                    text.append(buf[i])
+                i += 1
+                continue
+            self.frames += 1
+            if body[0] == FRAME_TEXT:
+                text += body[2:]
+            else:
+                frames.append((chr(body[0]), bytes(body[2:])))
+            i = end
+        self.pending = buf[i:]
+        return bytes(text), frames
+
+
+def describe_frame(ftype, payload):
+    def u32(at):
+        return int.from_bytes(payload[at:at + 4], "little")
+    if ftype == "E" and len(payload) == 5:
+        return "error at 0x%X, read %d" % (u32(0), payload[4])
+    if ftype == "C" and len(payload) == 5:
+        return "pattern %d done, %d errors" % (payload[0], u32(1))
+    if ftype == "D" and len(payload) == 4:
+        return "run done, %d errors" % u32(0)
+    if ftype == "P" and len(payload) == 1:
+        return "pattern %d" % payload[0]
+    return "frame %s %s" % (ftype, payload.hex())
+
+
+def looks_like_text(data):
+    printable = sum(1 for b in data if 32 <= b < 127 or b in (9, 10, 13, 27))
+    return b"\n" in data and printable >= 0.9 * len(data)
+
+
+def wait_banner(fd):
+    """Reads until the tester's banner shows up as text or CRC frames, so
+    nothing is sent while the bootloader still owns the line. Returns the
+    bytes read, or None when nothing readable arrives in time."""
+    seen = b""
+    deadline = time.time() + DETECT_SECONDS
+    while time.time() < deadline:
+        ready, _, _ = select.select([fd], [], [], 0.05)
+        if not ready:
+            continue
+        seen += os.read(fd, 4096)
+        probe = FrameDecoder()
+        probe.feed(seen)
+        if probe.frames or (len(seen) >= 16 and looks_like_text(seen)):
+            return seen
+    return None
+
+
+def detect_link(path):
+    """Opens the port at each candidate rate until the banner is readable.
+    Every open resets the board, so each try sees a fresh banner."""
+    for baud in BAUD_RATES:
+        try:
+            fd = open_port(path, baud)
+        except (AttributeError, termios.error):
+            continue  # rate not supported by this OS
+        seen = wait_banner(fd)
+        if seen is not None:
+            return fd, baud, seen
+        os.close(fd)
+    sys.exit("no tester found at %s" % ", ".join(str(b) for b in BAUD_RATES))
+
+
+def open_port(path, baud):
+    speed = getattr(termios, "B%d" % baud)
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    attrs[0] = 0                                           # iflag
+    attrs[1] = 0                                           # oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+    attrs[3] = 0                                           # lflag
+    attrs[4] = attrs[5] = speed
+    attrs[6][termios.VMIN] = 0
+    attrs[6][termios.VTIME] = 0
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
+
+
+class SqliteSink:
+    def __init__(self, path):
+        self.db = sqlite3.connect(path)
+        self.db.execute(
+            "CREATE TABLE IF NOT EXISTS chips ("
+            "id INTEGER PRIMARY KEY, lot TEXT, tested_at TEXT, seq INTEGER,"
+            "chip TEXT, class TEXT, errors INTEGER, first_fail TEXT,"
+            "failed_steps TEXT, retention_ms INTEGER, cac_sweep INTEGER,"
+            "rcd_sweep INTEGER, seconds INTEGER, fail_map TEXT)")
+        self.db.commit()
+
+    def add(self, lot, record, fail_map):
+        self.db.execute(
+            "INSERT INTO chips (lot, tested_at, seq, chip, class, errors, first_fail,"
+            "failed_steps, retention_ms, cac_sweep, rcd_sweep, seconds, fail_map)"
+            " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+            [lot, time.strftime("%Y-%m-%d %H:%M:%S")] + record + ["\n".join(fail_map)])
+        self.db.commit()
+
+
+class CsvSink:
+    def __init__(self, path):
+        new = not os.path.exists(path) or os.path.getsize(path) == 0
+        self.file = open(path, "a", newline="")
+        self.writer = csv.writer(self.file)
+        if new:
+            self.writer.writerow(["lot", "tested_at"] + FIELDS)
+            self.file.flush()
+
+    def add(self, lot, record, fail_map):
+        self.writer.writerow([lot, time.strftime("%Y-%m-%d %H:%M:%S")] + record)
+        self.file.flush()
+
+
+def parse_result(line):
+    parts = line.split(",")[1:]
+    if len(parts) != len(FIELDS):
+        return None
+    record = []
+    for name, value in zip(FIELDS, parts):
+        if name in ("chip", "class", "first_fail", "failed_steps"):
+            record.append(value)
+        else:
+            try:
+                record.append(int(value))
+            except ValueError:
+                return None
+    return record
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Log HM511000 salvage batch results")
+    ap.add_argument("port")
+    ap.add_argument("--baud", type=int, help="link rate; detected when omitted")
+    ap.add_argument("--lot", default=time.strftime("lot-%Y%m%d"))
+    out = ap.add_mutually_exclusive_group()
+    out.add_argument("--db", default="chips.sqlite")
+    out.add_argument("--csv")
+    args = ap.parse_args()
+
+    sink = CsvSink(args.csv) if args.csv else SqliteSink(args.db)
+    # Opening the port resets the board; answer its startup prompt
+    if args.baud:
+        fd = open_port(args.port, args.baud)
+        first = wait_banner(fd)
+        if first is None:
+            sys.exit("no banner from tester at %d baud" % args.baud)
+    else:
+        fd, baud, first = detect_link(args.port)
+        print("== link %d baud" % baud, flush=True)
+    os.write(fd, b"b")
+
+    started = time.time()
+    counts = {}
+    fail_map = []
+    pending = b""
+    decoder = FrameDecoder()
+
+    while True:
+        ready, _, _ = select.select([fd, sys.stdin], [], [])
+
+        if sys.stdin in ready:
+            if not sys.stdin.readline():
+                break
+            os.write(fd, b"t")
+
+        if fd not in ready:
+            continue
+        chunk = os.read(fd, 4096)
+        if not chunk:
+            print("!! port closed", file=sys.stderr)
+            break  # readable with no data: the adapter went away
+        data = first + chunk
+        first = b""
+        text, frames = decoder.feed(data)
+        for ftype, payload in frames:
+            print("[%s]" % describe_frame(ftype, payload), flush=True)
+        pending += text
+        while b"\n" in pending:
+            raw, pending = pending.split(b"\n", 1)
+            line = raw.decode("ascii", "replace").rstrip("\r")
+            print(line, flush=True)
+
+            if line.startswith("FR ") and len(fail_map) < MAX_FAIL_LINES:
+                fail_map.append(line)
+            if not line.startswith("RESULT,"):
+                continue
+
+            record = parse_result(line)
+            if record is None:
+                print("!! malformed result line", file=sys.stderr)
+                continue
+            sink.add(args.lot, record, fail_map)
+            fail_map = []
+
+            cls = record[FIELDS.index("class")]
+            counts[cls] = counts.get(cls, 0) + 1
+            total = sum(counts.values())
+            rate = total * 3600.0 / (time.time() - started)
+            summary = " ".join("%s=%d" % kv for kv in sorted(counts.items()))
+            print("== %d chips, %.1f/h: %s" % (total, rate, summary), flush=True)
+
+    os.close(fd)
+
+
+if __name__ == "__main__":
+    main()
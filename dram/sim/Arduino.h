@@ -0,0 +1,118 @@
+// Arduino.h (host simulator)
+// Stand-in for the AVR Arduino core, just large enough to compile the
+// dram/ testers natively. Port registers are objects whose reads and writes
+// drive a DramModel and advance a virtual clock by one CPU cycle per access.
+
+#pragma once
+
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define F(s) (s)
+
+#define A5 19
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+// Timer1 and status bits the testers touch
+#define CS10 0
+#define ICES1 6
+#define ICF1 5
+
+namespace sim {
+
+enum RegId {
+  REG_PORTB, REG_PORTC, REG_PORTD,
+  REG_DDRB, REG_DDRC, REG_DDRD,
+  REG_PINB, REG_PINC, REG_PIND,
+  REG_TCCR1A, REG_TCCR1B, REG_TIFR1, REG_TIMSK1,
+  REG_COUNT
+};
+
+extern uint64_t cycles; // virtual CPU cycles since reset, 16 per µs
+
+uint8_t readReg(RegId id);
+void writeReg(RegId id, uint8_t v);
+
+}  // namespace sim
+
+class Reg8 {
+ public:
+  explicit Reg8(sim::RegId id) : id_(id) {}
+  operator uint8_t() const { return sim::readReg(id_); }
+  Reg8 &operator=(unsigned long v) { sim::writeReg(id_, (uint8_t)v); return *this; }
+  Reg8 &operator=(const Reg8 &other) { return *this = (uint8_t)other; }
+  Reg8 &operator|=(unsigned long v) { return *this = (uint8_t)*this | v; }
+  Reg8 &operator&=(unsigned long v) { return *this = (uint8_t)*this & v; }
+  Reg8 &operator^=(unsigned long v) { return *this = (uint8_t)*this ^ v; }
+
+ private:
+  sim::RegId id_;
+};
+
+// TCNT1 follows the virtual clock while Timer1 runs at clk/1
+class Timer1Count {
+ public:
+  operator uint16_t() const;
+  Timer1Count &operator=(uint16_t v);
+};
+
+extern Reg8 PORTB, PORTC, PORTD, DDRB, DDRC, DDRD, PINB, PINC, PIND;
+extern Reg8 TCCR1A, TCCR1B, TIFR1, TIMSK1;
+extern Timer1Count TCNT1;
+extern uint8_t SREG;
+
+inline void cli() {}
+inline void sei() {}
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+// avr-gcc's exact busy-wait; here it only advances the virtual clock
+inline void __builtin_avr_delay_cycles(unsigned long n) { sim::cycles += n; }
+
+// Mid-scale reading after one 104 µs conversion
+int analogRead(uint8_t pin);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+class SimSerial {
+ public:
+  bool echo = false; // print to stdout; off for coverage runs
+
+  void begin(unsigned long) {}
+  int available() { return 0; }
+  int read() { return -1; }
+
+  void print(const char *s);
+  void print(char c);
+  void print(int v, int base = DEC) { print((long)v, base); }
+  void print(unsigned v, int base = DEC) { print((unsigned long)v, base); }
+  void print(long v, int base = DEC);
+  void print(unsigned long v, int base = DEC);
+  void print(double v, int digits = 2);
+  void println() { print('\n'); }
+  template <typename T> void println(T v) { print(v); println(); }
+  template <typename T> void println(T v, int base) { print(v, base); println(); }
+};
+
+extern SimSerial Serial;
@@ -0,0 +1,38 @@
+// EEPROM.h (host simulator)
+// 1 KiB EEPROM in RAM. Each byte that actually changes costs the ~3.3 ms
+// an ATmega328P takes to program it.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+void delayMicroseconds(unsigned int us);
+
+class EEPROMClass {
+ public:
+  EEPROMClass() { memset(mem_, 0xFF, sizeof(mem_)); }
+
+  template <typename T> T &get(int idx, T &t) {
+    memcpy(&t, mem_ + idx, sizeof(T));
+    return t;
+  }
+
+  template <typename T> const T &put(int idx, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for (size_t i = 0; i < sizeof(T); i++) update(idx + i, p[i]);
+    return t;
+  }
+
+  uint8_t read(int idx) { return mem_[idx]; }
+  void write(int idx, uint8_t v) { mem_[idx] = v; delayMicroseconds(3300); }
+  void update(int idx, uint8_t v) { if (mem_[idx] != v) write(idx, v); }
+  uint16_t length() { return sizeof(mem_); }
+
+  void erase() { memset(mem_, 0xFF, sizeof(mem_)); }
+
+ private:
+  uint8_t mem_[1024];
+};
+
+extern EEPROMClass EEPROM;
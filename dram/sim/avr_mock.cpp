@@ -0,0 +1,155 @@
+// avr_mock.cpp
+// Register file, virtual clock and Serial for the host simulator. Wiring
+// matches the Uno testers: A0–A5 on PD2–PD7, A6–A9 on PB0–PB3, DQ on PC0,
+// RAS/CAS/WE on PC1–PC3.
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "sim.h"
+
+#include <stdio.h>
+
+namespace sim {
+
+uint64_t cycles = 0;
+DramModel *chip = nullptr;
+
+static uint8_t regs[REG_COUNT];
+static uint64_t timer1Base = 0; // cycle at which TCNT1 read 0
+
+static uint16_t addressPins() {
+  return ((regs[REG_PORTD] >> 2) & 0x3F) | ((regs[REG_PORTB] & 0x0F) << 6);
+}
+
+static void notifyChip() {
+  if (!chip) return;
+  uint8_t c = regs[REG_PORTC];
+  chip->update(cycles, addressPins(), c & 0x02, c & 0x04, c & 0x08, c & 0x01);
+}
+
+uint8_t readReg(RegId id) {
+  cycles++;
+  if (id == REG_PINC) {
+    uint8_t pins = regs[REG_PORTC];
+    bool level;
+    // An input DQ shows the chip when it drives, otherwise the pull-up state
+    if (!(regs[REG_DDRC] & 0x01) && chip && chip->dqOut(cycles, level))
+      pins = (pins & ~0x01) | level;
+    return pins;
+  }
+  if (id == REG_PINB) return regs[REG_PORTB];
+  if (id == REG_PIND) return regs[REG_PORTD];
+  return regs[id];
+}
+
+void writeReg(RegId id, uint8_t v) {
+  cycles++;
+  regs[id] = v;
+  if (id == REG_PORTB || id == REG_PORTC || id == REG_PORTD) notifyChip();
+}
+
+void resetMcu() {
+  memset(regs, 0, sizeof(regs));
+  cycles = 0;
+  timer1Base = 0;
+  EEPROM.erase();
+}
+
+void advanceMicros(uint64_t us) {
+  cycles += us * 16;
+}
+
+}  // namespace sim
+
+Reg8 PORTB(sim::REG_PORTB), PORTC(sim::REG_PORTC), PORTD(sim::REG_PORTD);
+Reg8 DDRB(sim::REG_DDRB), DDRC(sim::REG_DDRC), DDRD(sim::REG_DDRD);
+Reg8 PINB(sim::REG_PINB), PINC(sim::REG_PINC), PIND(sim::REG_PIND);
+Reg8 TCCR1A(sim::REG_TCCR1A), TCCR1B(sim::REG_TCCR1B);
+Reg8 TIFR1(sim::REG_TIFR1), TIMSK1(sim::REG_TIMSK1);
+Timer1Count TCNT1;
+uint8_t SREG = 0x80;
+
+EEPROMClass EEPROM;
+SimSerial Serial;
+
+Timer1Count::operator uint16_t() const {
+  sim::cycles++;
+  return (uint16_t)(sim::cycles - sim::timer1Base);
+}
+
+Timer1Count &Timer1Count::operator=(uint16_t v) {
+  sim::cycles++;
+  sim::timer1Base = sim::cycles - v;
+  return *this;
+}
+
+// The AVR core reads Timer0 with interrupts off, about 50 cycles a call;
+// charging it also lets polling loops such as idleWithRefresh() end
+unsigned long micros() {
+  sim::cycles += 50;
+  return (unsigned long)(sim::cycles / 16);
+}
+
+unsigned long millis() {
+  sim::cycles += 50;
+  return (unsigned long)(sim::cycles / 16000);
+}
+void delay(unsigned long ms) { sim::advanceMicros((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { sim::advanceMicros(us); }
+
+int analogRead(uint8_t) {
+  sim::advanceMicros(104);
+  return 512;
+}
+
+// Own generator, like DramModel::reset(), so rand() stays with fault_sim
+static uint32_t randomState = 1;
+
+long random(long max) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return max > 0 ? (long)(randomState % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+  return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed) randomState = seed;
+}
+
+void SimSerial::print(const char *s) {
+  if (echo) fputs(s, stdout);
+}
+
+void SimSerial::print(char c) {
+  if (echo) putchar(c);
+}
+
+void SimSerial::print(long v, int base) {
+  if (v < 0) {
+    print('-');
+    print((unsigned long)-v, base);
+  } else {
+    print((unsigned long)v, base);
+  }
+}
+
+void SimSerial::print(unsigned long v, int base) {
+  if (!echo) return;
+  char buf[8 * sizeof(long) + 1];
+  char *p = buf + sizeof(buf) - 1;
+  *p = 0;
+  do {
+    unsigned digit = v % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    v /= base;
+  } while (v);
+  fputs(p, stdout);
+}
+
+void SimSerial::print(double v, int digits) {
+  if (echo) printf("%.*f", digits, v);
+}
@@ -0,0 +1,177 @@
+// dram_model.cpp
+// HM511000 behaviour at the RAS/CAS level:
+//   RAS fall, CAS high     -> row activation (RAS-only refresh or start of a cycle)
+//   RAS fall, CAS low      -> CAS-before-RAS refresh of the internal counter row
+//   CAS fall, WE low       -> early write of DQ
+//   CAS fall, WE high      -> read, DQ valid tCAC later until CAS rises
+//   WE fall with CAS low   -> late write (read-modify-write)
+// Retention is checked lazily whenever a row is activated.
+
+#include "dram_model.h"
+
+#include <stddef.h>
+
+DramModel::DramModel()
+    : goodRetentionMicros(2000000ULL),
+      tCacCycles(1),
+      refreshBits(9),
+      activations(0), reads(0), writes(0), refreshes(0),
+      cells_(ROWS * COLS / 8),
+      restored_(ROWS),
+      ras_(true), cas_(true), we_(true),
+      row_(0), col_(0), cbrCounter_(0),
+      driving_(false), outLevel_(false), outValidAt_(0) {}
+
+void DramModel::reset(uint64_t nowCycles, uint32_t seed) {
+  // Own generator so the caller's rand() sequence is left alone
+  uint32_t x = seed ? seed : 1;
+  for (size_t i = 0; i < cells_.size(); i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    cells_[i] = x & 0xFF;
+  }
+  for (int r = 0; r < ROWS; r++) restored_[r] = nowCycles;
+  faults_.clear();
+  ras_ = cas_ = we_ = true;
+  row_ = col_ = 0;
+  cbrCounter_ = 0;
+  driving_ = false;
+  activations = reads = writes = refreshes = 0;
+}
+
+void DramModel::addFault(const Fault &f) {
+  faults_.push_back(f);
+  if (f.type == FAULT_STUCK_AT) rawSet(f.row, f.col, f.value);
+}
+
+bool DramModel::rawGet(uint16_t row, uint16_t col) const {
+  uint32_t i = (uint32_t)row * COLS + col;
+  return (cells_[i >> 3] >> (i & 7)) & 1;
+}
+
+void DramModel::rawSet(uint16_t row, uint16_t col, bool v) {
+  uint32_t i = (uint32_t)row * COLS + col;
+  if (v) cells_[i >> 3] |= 1 << (i & 7);
+  else cells_[i >> 3] &= ~(1 << (i & 7));
+}
+
+// Address lines as the decoders see them after any line faults
+uint16_t DramModel::decode(uint16_t pins, bool isRow) const {
+  for (size_t i = 0; i < faults_.size(); i++) {
+    const Fault &f = faults_[i];
+    if (f.type != (isRow ? FAULT_ROW_LINE : FAULT_COL_LINE)) continue;
+    if (f.bit == f.bit2) {
+      if (f.value) pins |= 1 << f.bit;
+      else pins &= ~(1 << f.bit);
+    } else {
+      bool both = ((pins >> f.bit) & 1) && ((pins >> f.bit2) & 1);
+      pins &= ~((1 << f.bit) | (1 << f.bit2));
+      if (both) pins |= (1 << f.bit) | (1 << f.bit2);
+    }
+  }
+  return pins & ((1 << (isRow ? ROW_BITS : COL_BITS)) - 1);
+}
+
+void DramModel::restoreRow(uint16_t row, uint64_t now) {
+  uint64_t idleMicros = (now - restored_[row]) / 16;
+
+  if (idleMicros > goodRetentionMicros) {
+    // Whole row has leaked; model discharge as reading 0
+    for (int c = 0; c < COLS; c++) rawSet(row, c, 0);
+  } else {
+    for (size_t i = 0; i < faults_.size(); i++) {
+      const Fault &f = faults_[i];
+      if (f.type == FAULT_RETENTION && f.row == row && idleMicros > f.retentionMicros)
+        rawSet(f.row, f.col, f.value);
+    }
+  }
+  restored_[row] = now;
+}
+
+void DramModel::refreshRows(uint16_t row, uint64_t now) {
+  uint16_t mask = (1 << refreshBits) - 1;
+  for (uint16_t r = row & mask; r < ROWS; r += mask + 1) restoreRow(r, now);
+}
+
+bool DramModel::readCell(uint16_t row, uint16_t col) const {
+  for (size_t i = 0; i < faults_.size(); i++) {
+    const Fault &f = faults_[i];
+    if (f.type == FAULT_STUCK_AT && f.row == row && f.col == col) return f.value;
+  }
+  return rawGet(row, col);
+}
+
+void DramModel::writeCell(uint16_t row, uint16_t col, bool v) {
+  bool old = rawGet(row, col);
+  writes++;
+
+  for (size_t i = 0; i < faults_.size(); i++) {
+    const Fault &f = faults_[i];
+    if (f.row == row && f.col == col) {
+      if (f.type == FAULT_STUCK_AT) return;
+      if (f.type == FAULT_TRANSITION && old != v && v == f.value) return;
+    }
+  }
+
+  rawSet(row, col, v);
+
+  if (old == v) return;
+  for (size_t i = 0; i < faults_.size(); i++) {
+    const Fault &f = faults_[i];
+    if (f.aggRow != row || f.aggCol != col || v != f.value) continue;
+    if (f.type == FAULT_COUPLING_INV) rawSet(f.row, f.col, !rawGet(f.row, f.col));
+    if (f.type == FAULT_COUPLING_IDEM) rawSet(f.row, f.col, f.value);
+  }
+}
+
+void DramModel::update(uint64_t now, uint16_t addrPins, bool ras, bool cas, bool we, bool dqIn) {
+  // RAS edge
+  if (ras != ras_) {
+    if (!ras) {
+      if (!cas) {
+        refreshRows(cbrCounter_, now);
+        cbrCounter_ = (cbrCounter_ + 1) & ((1 << refreshBits) - 1);
+        refreshes++;
+      } else {
+        row_ = decode(addrPins, true);
+        refreshRows(row_, now);
+        activations++;
+      }
+    }
+    ras_ = ras;
+  }
+
+  // CAS edge
+  if (cas != cas_) {
+    if (!cas && !ras_) {
+      col_ = decode(addrPins, false);
+      if (!we) {
+        writeCell(row_, col_, dqIn);
+      } else {
+        outLevel_ = readCell(row_, col_);
+        outValidAt_ = now + tCacCycles;
+        driving_ = true;
+        reads++;
+      }
+    } else if (cas) {
+      driving_ = false;
+    }
+    cas_ = cas;
+  }
+
+  // Late write inside an open cycle
+  if (we != we_) {
+    if (!we && !cas_ && !ras_) {
+      driving_ = false;
+      writeCell(row_, col_, dqIn);
+    }
+    we_ = we;
+  }
+}
+
+bool DramModel::dqOut(uint64_t now, bool &level) const {
+  if (!driving_ || now < outValidAt_) return false;
+  level = outLevel_;
+  return true;
+}
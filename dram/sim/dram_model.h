@@ -0,0 +1,80 @@
+// dram_model.h
+// Pin-level model of a 1Mx1 HM511000 (1024 rows x 1024 columns) with
+// injectable faults. The mocked AVR ports in avr_mock.cpp feed it every
+// change of the address bus, RAS, CAS, WE and DQ; it answers with the level
+// the chip drives on DQ.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+enum FaultType {
+  FAULT_STUCK_AT,        // cell always reads `value`
+  FAULT_TRANSITION,      // cell cannot make the transition to `value`
+  FAULT_COUPLING_INV,    // aggressor transition to `value` inverts victim
+  FAULT_COUPLING_IDEM,   // aggressor transition to `value` forces victim to `value`
+  FAULT_RETENTION,       // cell leaks to `value` after `retentionMicros` without restore
+  FAULT_ROW_LINE,        // row address bit `bit` stuck at `value`, or shorted to `bit2`
+  FAULT_COL_LINE         // same for the column address
+};
+
+struct Fault {
+  FaultType type;
+  uint16_t row, col;       // victim cell
+  uint16_t aggRow, aggCol; // coupling aggressor
+  bool value;
+  uint8_t bit, bit2;       // address lines; bit2 == bit means stuck, else wired-AND short
+  uint64_t retentionMicros;
+};
+
+class DramModel {
+ public:
+  static const int ROW_BITS = 10;
+  static const int COL_BITS = 10;
+  static const int ROWS = 1 << ROW_BITS;
+  static const int COLS = 1 << COL_BITS;
+
+  DramModel();
+
+  // Random power-up contents, no faults, all rows freshly restored at `now`
+  void reset(uint64_t nowCycles, uint32_t seed);
+  void addFault(const Fault &f);
+
+  // Pin update; times are in CPU cycles (16 per µs)
+  void update(uint64_t nowCycles, uint16_t addrPins, bool ras, bool cas, bool we, bool dqIn);
+
+  // True and sets `level` when the chip is driving DQ at `nowCycles`
+  bool dqOut(uint64_t nowCycles, bool &level) const;
+
+  // Good cells hold data this long without a restore
+  uint64_t goodRetentionMicros;
+  // CAS-to-data time, in cycles
+  uint8_t tCacCycles;
+  // Row bits a refresh decodes; the HM511000 ignores A9 and restores both
+  // halves of the array in one of its 512 refresh cycles
+  uint8_t refreshBits;
+
+  // Bus activity since reset
+  uint64_t activations, reads, writes, refreshes;
+
+ private:
+  std::vector<uint8_t> cells_;     // one bit per cell, row-major
+  std::vector<uint64_t> restored_; // cycle of the last restore per row
+  std::vector<Fault> faults_;
+
+  bool ras_, cas_, we_;
+  uint16_t row_, col_;
+  uint16_t cbrCounter_;
+  bool driving_;
+  bool outLevel_;
+  uint64_t outValidAt_;
+
+  bool rawGet(uint16_t row, uint16_t col) const;
+  void rawSet(uint16_t row, uint16_t col, bool v);
+  uint16_t decode(uint16_t pins, bool isRow) const;
+  void restoreRow(uint16_t row, uint64_t now);
+  void refreshRows(uint16_t row, uint64_t now);
+  bool readCell(uint16_t row, uint16_t col) const;
+  void writeCell(uint16_t row, uint16_t col, bool v);
+};
@@ -0,0 +1,240 @@
+// fault_sim.cpp
+// Fault-coverage bench for the port-level tester. 511000_opt.ino is
+// compiled unchanged against the mocked AVR core; each test algorithm is
+// run once on a fault-free chip to get its bus time, then against every
+// injected fault instance to see whether it reports an error.
+//
+// Usage: fault_sim [-n instances] [-s seed] [-a name-filter] [-v]
+
+#include "Arduino.h"
+#include "sim.h"
+
+#include "../511000_opt.ino"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Tester region for the selected chip profile inside the 1024x1024 model
+static const uint16_t TEST_ROWS = rowCount;
+static const uint16_t TEST_COLS = colCount;
+static const uint8_t TEST_ROW_BITS = rowBits;
+static const uint8_t TEST_COL_BITS = colBits;
+
+struct Algorithm {
+  const char *name;
+  uint32_t (*run)();
+};
+
+template <uint8_t P> uint32_t fixedPattern() {
+  runPatternWithLatency(P);
+  return 0;
+}
+
+// Two patterns chained through an RMW read pass, as runFullTest() does
+template <uint8_t P> uint32_t chainedPattern() {
+  runPatternWithLatency(P, false, P + 1);
+  runPatternWithLatency(P + 1, true);
+  return 0;
+}
+
+template <uint8_t B> uint32_t march() { return marchCMinus(B); }
+
+static uint32_t prescreen() { return addressPrescreen(); }
+static uint32_t lfsr() { return runLfsrPattern(0xACE1); }
+static uint32_t neighbourhood0() { return neighbourhoodTest(false); }
+static uint32_t neighbourhood1() { return neighbourhoodTest(true); }
+static uint32_t batchChip() {
+  testBatchChip();
+  return 0;
+}
+
+// One round of soak passes: the chained patterns and the eighth pass
+static uint32_t soak() {
+  startSoakMode();
+  uint32_t errors = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    soakPass();
+    errors += checkpoint.errors;
+  }
+  soakMode = countRowErrors = false;
+  return errors;
+}
+
+static const Algorithm algorithms[] = {
+  {"prescreen", prescreen},
+  {"pattern0", fixedPattern<0>},
+  {"pattern1", fixedPattern<1>},
+  {"pattern2", fixedPattern<2>},
+  {"pattern3", fixedPattern<3>},
+  {"pattern4", fixedPattern<4>},
+  {"pattern5", fixedPattern<5>},
+  {"pattern6", fixedPattern<6>},
+  {"pattern2>3", chainedPattern<2>},
+  {"lfsr", lfsr},
+  {"marchC-bg0", march<0>},
+  {"marchC-bg1", march<1>},
+  {"marchC-bg2", march<2>},
+  {"marchC-bg3", march<3>},
+  {"neigh0", neighbourhood0},
+  {"neigh1", neighbourhood1},
+  {"batch", batchChip},
+  {"soak", soak},
+};
+static const int ALGORITHM_COUNT = sizeof(algorithms) / sizeof(algorithms[0]);
+
+struct FaultClass {
+  const char *name;
+  Fault (*make)();
+};
+
+static Fault blankFault(FaultType type) {
+  Fault f;
+  memset(&f, 0, sizeof(f));
+  f.type = type;
+  f.row = rand() % TEST_ROWS;
+  f.col = rand() % TEST_COLS;
+  f.aggRow = f.aggCol = 0xFFFF;
+  f.value = rand() & 1;
+  return f;
+}
+
+// Aggressor one cell away in a random direction, clipped to the region
+static void pickNeighbour(Fault &f) {
+  int dr = 0, dc = 0;
+  switch (rand() % 4) {
+    case 0: dr = -1; break;
+    case 1: dr = 1; break;
+    case 2: dc = -1; break;
+    default: dc = 1; break;
+  }
+  int r = f.row + dr, c = f.col + dc;
+  if (r < 0 || r >= TEST_ROWS) r = f.row - dr;
+  if (c < 0 || c >= TEST_COLS) c = f.col - dc;
+  f.aggRow = r;
+  f.aggCol = c;
+}
+
+static Fault stuckAt() { return blankFault(FAULT_STUCK_AT); }
+static Fault transition() { return blankFault(FAULT_TRANSITION); }
+
+static Fault couplingInv() {
+  Fault f = blankFault(FAULT_COUPLING_INV);
+  pickNeighbour(f);
+  return f;
+}
+
+static Fault couplingIdem() {
+  Fault f = blankFault(FAULT_COUPLING_IDEM);
+  pickNeighbour(f);
+  return f;
+}
+
+static Fault retention() {
+  Fault f = blankFault(FAULT_RETENTION);
+  f.retentionMicros = 10000; // leaks well inside one pattern pass
+  return f;
+}
+
+static Fault lineFault(FaultType type, uint8_t bits, bool shorted) {
+  Fault f = blankFault(type);
+  f.bit = rand() % bits;
+  f.bit2 = f.bit;
+  if (shorted) {
+    while (f.bit2 == f.bit) f.bit2 = rand() % bits;
+  }
+  return f;
+}
+
+static Fault rowStuck() { return lineFault(FAULT_ROW_LINE, TEST_ROW_BITS, false); }
+static Fault rowShort() { return lineFault(FAULT_ROW_LINE, TEST_ROW_BITS, true); }
+static Fault colStuck() { return lineFault(FAULT_COL_LINE, TEST_COL_BITS, false); }
+static Fault colShort() { return lineFault(FAULT_COL_LINE, TEST_COL_BITS, true); }
+
+static const FaultClass faultClasses[] = {
+  {"SAF", stuckAt},
+  {"TF", transition},
+  {"CFin", couplingInv},
+  {"CFid", couplingIdem},
+  {"RET", retention},
+  {"RowStk", rowStuck},
+  {"RowSht", rowShort},
+  {"ColStk", colStuck},
+  {"ColSht", colShort},
+};
+static const int FAULT_CLASS_COUNT = sizeof(faultClasses) / sizeof(faultClasses[0]);
+
+static DramModel chipModel;
+
+// Power-up state for one run: fresh MCU, random array, tester globals reset
+static void powerUp(uint32_t seed) {
+  sim::resetMcu();
+  chipModel.reset(0, seed);
+  sim::chip = &chipModel;
+
+  memset(&checkpoint, 0, sizeof(checkpoint));
+  lastRefreshMicros = 0;
+  preloadedPattern = NO_PATTERN;
+  setupPins();
+}
+
+static bool runDetects(const Algorithm &alg) {
+  uint32_t reported = alg.run();
+  return reported != 0 || checkpoint.errors != 0;
+}
+
+int main(int argc, char **argv) {
+  int instances = 2;
+  uint32_t seed = 1;
+  const char *filter = nullptr;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:a:v")) != -1) {
+    switch (opt) {
+      case 'n': instances = atoi(optarg); break;
+      case 's': seed = strtoul(optarg, nullptr, 0); break;
+      case 'a': filter = optarg; break;
+      case 'v': Serial.echo = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-n instances] [-s seed] [-a name-filter] [-v]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  printf("%-12s %9s %8s", "algorithm", "time_s", "fp");
+  for (int f = 0; f < FAULT_CLASS_COUNT; f++) printf(" %6s", faultClasses[f].name);
+  printf("\n");
+
+  bool anyFalsePositive = false;
+  for (int a = 0; a < ALGORITHM_COUNT; a++) {
+    const Algorithm &alg = algorithms[a];
+    if (filter && !strstr(alg.name, filter)) continue;
+
+    // Fault-free run: bus time and false positives
+    powerUp(seed);
+    bool falsePositive = runDetects(alg);
+    anyFalsePositive |= falsePositive;
+    double seconds = sim::cycles / 16e6;
+
+    printf("%-12s %9.2f %8s", alg.name, seconds, falsePositive ? "YES" : "no");
+    fflush(stdout);
+
+    for (int f = 0; f < FAULT_CLASS_COUNT; f++) {
+      int detected = 0;
+      srand(seed * 7919 + f);
+      for (int i = 0; i < instances; i++) {
+        Fault fault = faultClasses[f].make();
+        powerUp(seed + i);
+        chipModel.addFault(fault);
+        if (runDetects(alg)) detected++;
+      }
+      printf(" %5d%%", instances ? detected * 100 / instances : 0);
+      fflush(stdout);
+    }
+    printf("\n");
+  }
+
+  // A tester that flags a good chip is broken whatever it detects
+  return anyFalsePositive ? 1 : 0;
+}
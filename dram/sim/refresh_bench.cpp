@@ -0,0 +1,30 @@
+// refresh_bench.cpp
+// Runs ../511000_refresh_bench.ino unchanged against the mocked AVR core,
+// so its per-mode timings and retention verdicts can be reproduced. Good
+// cells hold their data for `retention` ms (default 2000); cutting it
+// shows which refresh strategies still keep up.
+//
+// Usage: refresh_bench [retention-ms]
+
+#include "Arduino.h"
+#include "sim.h"
+
+#include "../511000_refresh_bench.ino"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+  static DramModel model;
+  sim::resetMcu();
+  model.reset(0, 1);
+  if (argc > 1) model.goodRetentionMicros = strtoul(argv[1], nullptr, 0) * 1000ULL;
+  sim::chip = &model;
+
+  Serial.echo = true;
+  setup();
+
+  printf("%.2f s simulated, %llu refreshes seen by the chip\n", sim::cycles / 16e6,
+         (unsigned long long)model.refreshes);
+  return 0;
+}
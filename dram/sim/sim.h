@@ -0,0 +1,18 @@
+// sim.h
+// Host-side hooks shared by the mocked AVR core and the fault simulator.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "dram_model.h"
+
+namespace sim {
+
+extern DramModel *chip;
+
+// Clears registers, the virtual clock and EEPROM, as after power-up
+void resetMcu();
+void advanceMicros(uint64_t us);
+
+}  // namespace sim
@@ -0,0 +1,57 @@
+// simple_run.cpp
+// Runs ../511000_simple.ino unchanged against the mocked AVR core and
+// reports the simulated time of its full pattern suite, fixed pauses
+// included. This is the figure the page-mode runner in dram_core.h is
+// measured by. With -f two stuck-at cells and a stuck column line are
+// injected, so the error report can be compared across core changes.
+//
+// Usage: simple_run [-f] [-q]
+
+#include "Arduino.h"
+#include "sim.h"
+
+#include "../511000_simple.ino"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  bool faults = false;
+  bool quiet = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "fq")) != -1) {
+    switch (opt) {
+      case 'f': faults = true; break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-f] [-q]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  static DramModel model;
+  sim::resetMcu();
+  model.reset(0, 1);
+  if (faults) {
+    Fault f = {};
+    f.type = FAULT_STUCK_AT;
+    f.row = 300; f.col = 517; f.value = 1;
+    model.addFault(f);
+    f.row = 3; f.col = 8; f.value = 0;
+    model.addFault(f);
+
+    Fault line = {};
+    line.type = FAULT_COL_LINE;
+    line.bit = line.bit2 = 4;
+    line.value = 0;
+    model.addFault(line);
+  }
+  sim::chip = &model;
+
+  Serial.echo = !quiet;
+  setup();
+
+  printf("%.2f s simulated\n", sim::cycles / 16e6);
+  return 0;
+}
@@ -1,2 +1,10 @@
 gcc -o test_vram_write test_vram_write.c
 sudo ./test_vram_write
+gcc -O2 -o vram_bench vram_bench.c
+sudo ./vram_bench 1000
+gcc -O2 -o vram_pwrite vram_pwrite.c
+sudo ./vram_pwrite
+gcc -O2 -o vram_scatter vram_scatter.c
+sudo ./vram_scatter
+gcc -O2 -o vram_vsync vram_vsync.c
+sudo ./vram_vsync 70
@@ -14,6 +14,9 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "../../kernel/vram_ioctl.h"
 
 static int vram_fd = -1;
 static uint8_t *vram_map = NULL;
@@ -26,7 +29,9 @@ int vga_direct_init(const char *path, off_t physaddr, size_t size)
     const char *dev = path ? path : "/dev/vram";
     struct stat st;
 
-    vram_fd = open(dev, O_RDWR | O_SYNC);
+    // no O_SYNC: that would force an uncached mapping even when the module
+    // was loaded with writecombine=1
+    vram_fd = open(dev, O_RDWR);
     if (vram_fd < 0) {
         // not available — caller should fallback
         return 0;
@@ -87,3 +92,30 @@ int vga_direct_write(int row, int col, const unsigned char *s, int len, unsigned
     }
     return len;
 }
+
+// write a whole 80x25 screen of character/attribute pairs with one pwrite();
+// cheaper than page-table setup when a tool only updates the screen once
+int vga_direct_put_screen(const unsigned char *cells, size_t len)
+{
+    if (vram_fd < 0) return 0;
+    if (len > 80 * 25 * 2) len = 80 * 25 * 2;
+    return pwrite(vram_fd, cells, len, 0) == (ssize_t)len;
+}
+
+// apply a batch of {offset, length, data} updates with one ioctl, e.g. the
+// cells that changed since the last frame; no mmap, no syscall per cell
+int vga_direct_scatter(const struct vram_segment *segs, unsigned int count)
+{
+    struct vram_scatter req = { (uintptr_t)segs, count, 0 };
+    if (vram_fd < 0) return 0;
+    return ioctl(vram_fd, VRAM_IOC_SCATTER, &req) == 0;
+}
+
+// block until the next vertical retrace, so the following updates land
+// while the beam is off screen; returns 0 when retrace cannot be seen
+int vga_direct_wait_vsync(void)
+{
+    __u64 count;
+    if (vram_fd < 0) return 0;
+    return ioctl(vram_fd, VRAM_IOC_WAIT_VSYNC, &count) == 0;
+}
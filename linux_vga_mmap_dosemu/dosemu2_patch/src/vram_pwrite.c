@@ -0,0 +1,62 @@
+// vram_pwrite.c
+// Writes a whole 80x25 text screen (4000 bytes of character/attribute
+// pairs) to /dev/vram with a single pwrite(), no mmap needed. The screen
+// image comes from a file, or stdin with "-"; without one a test screen
+// is drawn.
+//
+// Usage: vram_pwrite [screen.bin|-] [device]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+
+#define SCREEN_BYTES (80 * 25 * 2)
+
+static void test_screen(uint8_t *cells){
+    int row, col;
+    for (row = 0; row < 25; ++row){
+        for (col = 0; col < 80; ++col){
+            size_t idx = (row * 80 + col) * 2;
+            cells[idx] = 'A' + (row + col) % 26;
+            cells[idx+1] = (row % 7 + 1) | 0x10; // colour on blue
+        }
+    }
+}
+
+static int load_screen(const char *path, uint8_t *cells){
+    FILE *f = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    if (!f) { perror(path); return 0; }
+    size_t n = fread(cells, 1, SCREEN_BYTES, f);
+    if (f != stdin) fclose(f);
+    if (n != SCREEN_BYTES){
+        fprintf(stderr, "%s: expected %d bytes, got %zu\n", path, SCREEN_BYTES, n);
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv){
+    uint8_t cells[SCREEN_BYTES];
+    const char *dev = argc > 2 ? argv[2] : "/dev/vram";
+
+    if (argc > 1){
+        if (!load_screen(argv[1], cells)) return 1;
+    } else {
+        test_screen(cells);
+    }
+
+    int fd = open(dev, O_WRONLY);
+    if (fd < 0) { perror("open"); return 1; }
+    ssize_t n = pwrite(fd, cells, SCREEN_BYTES, 0);
+    if (n != SCREEN_BYTES){
+        if (n < 0) perror("pwrite");
+        else fprintf(stderr, "short write: %zd of %d bytes\n", n, SCREEN_BYTES);
+        close(fd);
+        return 1;
+    }
+    close(fd);
+    return 0;
+}
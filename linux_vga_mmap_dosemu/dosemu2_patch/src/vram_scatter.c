@@ -0,0 +1,47 @@
+// vram_scatter.c
+// Updates scattered cells of the 80x25 text screen with one VRAM_IOC_SCATTER
+// call: a diagonal of single cells plus a message line, the shape of a
+// frame's dirty cells in an emulator.
+//
+// Usage: vram_scatter [device]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../../kernel/vram_ioctl.h"
+
+int main(int argc, char **argv){
+    const char *dev = argc > 1 ? argv[1] : "/dev/vram";
+    static const char msg[] = "Scattered update via VRAM_IOC_SCATTER";
+    uint8_t diag[25][2];
+    uint8_t line[sizeof(msg) * 2];
+    struct vram_segment segs[26];
+    int i;
+
+    for (i = 0; i < 25; ++i){
+        diag[i][0] = '*';
+        diag[i][1] = 0x0E; // yellow on black
+        segs[i].offset = (i * 80 + i * 3) * 2;
+        segs[i].length = 2;
+        segs[i].data = (uintptr_t)diag[i];
+    }
+    for (i = 0; msg[i]; ++i){
+        line[i * 2] = msg[i];
+        line[i * 2 + 1] = 0x1F; // white on blue
+    }
+    segs[25].offset = (12 * 80 + 30) * 2;
+    segs[25].length = strlen(msg) * 2;
+    segs[25].data = (uintptr_t)line;
+
+    int fd = open(dev, O_WRONLY);
+    if (fd < 0) { perror("open"); return 1; }
+    struct vram_scatter req = { (uintptr_t)segs, 26, 0 };
+    if (ioctl(fd, VRAM_IOC_SCATTER, &req) < 0) { perror("VRAM_IOC_SCATTER"); close(fd); return 1; }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// vram_vsync.c
+// Waits for vertical retrace through /dev/vram, first with
+// VRAM_IOC_WAIT_VSYNC and then with poll(POLLPRI), and prints the measured
+// refresh rate for each. The module must be loaded with vsync=1.
+//
+// Usage: vram_vsync [frames] [device]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../../kernel/vram_ioctl.h"
+
+static double now_seconds(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *how, int frames, double t){
+    printf("%-6s %d retraces in %.3f s: %.2f Hz\n", how, frames, t, frames / t);
+}
+
+int main(int argc, char **argv){
+    int frames = argc > 1 ? atoi(argv[1]) : 70;
+    const char *dev = argc > 2 ? argv[2] : "/dev/vram";
+    __u64 count;
+    int i;
+
+    if (frames <= 0) { fprintf(stderr, "usage: %s [frames] [device]\n", argv[0]); return 1; }
+    int fd = open(dev, O_RDONLY);
+    if (fd < 0) { perror("open"); return 1; }
+
+    // the first wait only syncs up
+    if (ioctl(fd, VRAM_IOC_WAIT_VSYNC, &count) < 0) { perror("VRAM_IOC_WAIT_VSYNC"); return 1; }
+    double t0 = now_seconds();
+    for (i = 0; i < frames; ++i){
+        if (ioctl(fd, VRAM_IOC_WAIT_VSYNC, &count) < 0) { perror("VRAM_IOC_WAIT_VSYNC"); return 1; }
+    }
+    report("ioctl", frames, now_seconds() - t0);
+
+    struct pollfd p = { fd, POLLPRI, 0 };
+    poll(&p, 1, 100); // drop any retrace pending from before
+    t0 = now_seconds();
+    for (i = 0; i < frames; ++i){
+        int n = poll(&p, 1, 100);
+        if (n <= 0) { fprintf(stderr, "poll: %s\n", n ? "error" : "no retrace in 100 ms"); return 1; }
+    }
+    report("poll", frames, now_seconds() - t0);
+
+    close(fd);
+    return 0;
+}
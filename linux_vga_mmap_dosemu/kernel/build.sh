@@ -2,4 +2,8 @@ make
 sudo insmod ./vram_mmap.ko
 # optionally override parameters:
 # sudo insmod ./vram_mmap.ko phys_addr=0xa0000 vsize=0x20000
+# write-combining mappings (O_SYNC opens stay uncached):
+# sudo insmod ./vram_mmap.ko writecombine=1
+# RAM shadow flushed to VRAM 20 ms after the first write:
+# sudo insmod ./vram_mmap.ko defio=1 defio_ms=20
 ls -l /dev/vram
@@ -0,0 +1,45 @@
+// vram_ioctl.h
+// ioctl interface of /dev/vram, shared by vram_mmap.c and userspace.
+//
+// VRAM_IOC_SCATTER applies a batch of {offset, length, data} segments in one
+// call, e.g. the dirty cells of a frame. Offsets and lengths are checked
+// against the region before any segment is written, and the lengths may
+// add up to at most four times the region size (E2BIG otherwise). Segment
+// data is copied as it is stored, so a bad data pointer (EFAULT) or a fatal
+// signal (EINTR) ends the call with the segments before it already applied.
+// In defio mode they go to the shadow like any other write.
+//
+// VRAM_IOC_WAIT_VSYNC blocks until the next vertical retrace starts and
+// stores a running count of the retraces seen. Retrace is only sampled
+// while a caller is blocked, so frames nobody waited for are not counted.
+// It fails with ETIMEDOUT when no retrace comes within 100 ms, and with
+// EOPNOTSUPP unless the module was loaded with vsync=1. poll() then
+// reports EPOLLPRI once per retrace.
+
+#ifndef VRAM_IOCTL_H
+#define VRAM_IOCTL_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define VRAM_IOC_MAGIC 'V'
+
+// Pointers travel as __u64 so 32-bit callers share the 64-bit layout
+struct vram_segment {
+    __u32 offset;  // byte offset into VRAM
+    __u32 length;  // bytes
+    __u64 data;    // user pointer to `length` bytes
+};
+
+struct vram_scatter {
+    __u64 segments; // user pointer to `count` struct vram_segment
+    __u32 count;    // at most VRAM_MAX_SEGMENTS
+    __u32 reserved; // must be 0
+};
+
+#define VRAM_MAX_SEGMENTS 4096
+
+#define VRAM_IOC_SCATTER _IOW(VRAM_IOC_MAGIC, 1, struct vram_scatter)
+#define VRAM_IOC_WAIT_VSYNC _IOR(VRAM_IOC_MAGIC, 2, __u64)
+
+#endif
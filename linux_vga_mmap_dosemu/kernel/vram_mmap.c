@@ -1,5 +1,11 @@
 // vram_mmap.c
 // Simple kernel module exposing physical VGA text-mode memory (default 0xB8000) via /dev/vram
+// mmap maps the memory itself; read/write/pwrite copy through an ioremap of it,
+// which suits one-shot updates such as a whole screen in one syscall.
+// With defio=1, mmap and read/write use a RAM shadow instead and a worker
+// copies dirty pages to VRAM (deferred I/O, as fb_defio).
+// VRAM_IOC_SCATTER (vram_ioctl.h) applies many scattered updates in one call.
+// With vsync=1, VRAM_IOC_WAIT_VSYNC and poll() (EPOLLPRI) report vertical retrace.
 // Build with the provided Makefile.
 
 #include <linux/module.h>
@@ -10,10 +16,24 @@
 #include <linux/device.h>
 #include <linux/slab.h>
 #include <linux/io.h>
+#include <linux/vmalloc.h>
+#include <linux/bitmap.h>
+#include <linux/workqueue.h>
+#include <linux/pagemap.h>
+#include <linux/rmap.h>
+#include <linux/version.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/sched/signal.h>
+
+#include "vram_ioctl.h"
 
 MODULE_LICENSE("GPL");
 MODULE_AUTHOR("Assistant");
-MODULE_DESCRIPTION("Expose VGA text-mode VRAM via /dev/vram (mmap to physical memory).");
+MODULE_DESCRIPTION("Expose VGA text-mode VRAM via /dev/vram (mmap, read/write, vsync).");
 
 static unsigned long phys_addr = 0xb8000;
 module_param(phys_addr, ulong, 0444);
@@ -23,17 +43,384 @@ static unsigned long vsize = 0x4000; // 16KiB default (text mode)
 module_param(vsize, ulong, 0444);
 MODULE_PARM_DESC(vsize, "Size of VRAM region (default 0x4000)");
 
+static bool writecombine;
+module_param(writecombine, bool, 0644);
+MODULE_PARM_DESC(writecombine, "Map write-combining unless opened with O_SYNC (default 0: uncached; has no effect below 1 MiB on x86)");
+
+static bool defio;
+module_param(defio, bool, 0444);
+MODULE_PARM_DESC(defio, "Map a RAM shadow, flushed to VRAM in the background (default 0)");
+
+static unsigned int defio_ms = 20;
+module_param(defio_ms, uint, 0644);
+MODULE_PARM_DESC(defio_ms, "Shadow flush delay after the first write, in ms (default 20)");
+
+static bool vsync;
+module_param(vsync, bool, 0444);
+MODULE_PARM_DESC(vsync, "Enable VRAM_IOC_WAIT_VSYNC and EPOLLPRI (default 0; sampling 0x3DA resets the attribute controller flip-flop)");
+
+/* read/write bounce buffer size; a whole 80x25 text screen fits in one */
+#define VRAM_CHUNK PAGE_SIZE
+
 static dev_t devt;
 static struct cdev vram_cdev;
 static struct class *vram_class;
+static void __iomem *vram_base;
+
+/*
+ * With PAT, pgprot_writecombine() is all a mapping needs. Without it the
+ * PTE can only ask for WC where an MTRR allows it, so a load with
+ * writecombine=1 adds one through arch_phys_wc_add() (a no-op under PAT).
+ * Neither helps in the legacy VGA hole: PAT leaves the ISA range untracked
+ * and maps it write-back, and the fixed-range MTRRs that cover the first
+ * MiB (uncached there on PC firmware) override any variable MTRR. The
+ * effective type at 0xB8000 stays UC; only a phys_addr above 1 MiB, such
+ * as a linear aperture that aliases text memory, can be write-combined.
+ */
+#define VRAM_ISA_END 0x100000
+static int vram_wc_cookie;
+
+static void vram_unmap(void)
+{
+    arch_phys_wc_del(vram_wc_cookie);
+    iounmap(vram_base);
+}
+
+/*
+ * Deferred I/O state. shadow is what userspace sees. Pages of the shadow
+ * are mapped read-only until written; the write fault marks the page dirty
+ * and arms the flush, and the flush write-protects the page again before
+ * copying all of it, as fb_defio does. VRAM is shared with vgacon and
+ * with mode changes, so no copy of what it holds is trusted for skipping
+ * unchanged bytes.
+ */
+static u8 *shadow;
+static unsigned long *dirty_pages;
+static unsigned long shadow_pages;
+static struct delayed_work flush_work;
+
+/*
+ * Vertical retrace tracking. Bit 3 of input status register 1 is set for
+ * the vertical sync pulse only, two scan lines (~64 us) in the VGA text
+ * modes, so the register is sampled by an hrtimer in two phases:
+ *  - scanning: one sample every VSYNC_SCAN_US, shorter than the pulse;
+ *  - locked: once two retraces have given the period, the timer fires
+ *    VSYNC_LEAD_US before the next one is due and spins across it, at most
+ *    2 * VSYNC_LEAD_US. A miss drops back to scanning.
+ * The timer is a soft one, so the spin runs in softirq context rather than
+ * with interrupts off, and it only runs while a caller is blocked in
+ * VRAM_IOC_WAIT_VSYNC or in poll(). A wait that starts within the frame
+ * after the last retrace keeps the lock.
+ *
+ * Reading the status register also resets the attribute controller's
+ * index/data flip-flop at 0x3C0. A DOS program or vgacon that is between
+ * the index and data writes there has its data taken as an index, which
+ * garbles palette or mode registers. The ports cannot be requested away
+ * from vgacon, so tracking is off unless the module is loaded with vsync=1.
+ */
+#define VGA_STATUS_COLOR 0x3da
+#define VGA_STATUS_MONO 0x3ba
+#define VGA_VRETRACE 0x08
+
+#define VSYNC_SCAN_US 40
+#define VSYNC_LEAD_US 100
+#define VSYNC_MIN_US 5000      /* 200 Hz: two samples of one pulse */
+#define VSYNC_MAX_US 40000     /* 25 Hz */
+#define VSYNC_TIMEOUT_MS 100
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,16,0)
+#define VSYNC_TIMER_MODE HRTIMER_MODE_REL_SOFT
+#else
+#define VSYNC_TIMER_MODE HRTIMER_MODE_REL
+#endif
+
+static unsigned int vga_status_port;
+static struct hrtimer vsync_timer;
+static DEFINE_SPINLOCK(vsync_lock);
+static bool vsync_running;
+static unsigned int vsync_waiters;   /* callers in VRAM_IOC_WAIT_VSYNC */
+static ktime_t vsync_last;           /* start of the last retrace seen */
+static unsigned int vsync_period_us; /* 0 while scanning */
+static u64 vsync_count;              /* retraces seen since load */
+static DECLARE_WAIT_QUEUE_HEAD(vsync_wait);
+
+struct vram_file {
+    u64 vsync_seen; /* vsync_count at the last EPOLLPRI reported */
+};
+
+static u64 vsync_read_count(void)
+{
+    unsigned long flags;
+    u64 count;
+
+    spin_lock_irqsave(&vsync_lock, flags);
+    count = vsync_count;
+    spin_unlock_irqrestore(&vsync_lock, flags);
+    return count;
+}
+
+static enum hrtimer_restart vsync_tick(struct hrtimer *timer)
+{
+    bool in_retrace = inb(vga_status_port) & VGA_VRETRACE;
+    unsigned int next_us = VSYNC_SCAN_US;
+    ktime_t now;
+
+    if (!in_retrace && vsync_period_us) {
+        ktime_t deadline = ktime_add_us(ktime_get(), 2 * VSYNC_LEAD_US);
+
+        while (!(in_retrace = inb(vga_status_port) & VGA_VRETRACE) &&
+               ktime_before(ktime_get(), deadline))
+            cpu_relax();
+    }
+    now = ktime_get();
+
+    spin_lock(&vsync_lock);
+    if (in_retrace) {
+        s64 since = ktime_us_delta(now, vsync_last);
+
+        /* A pulse sampled twice while scanning counts once */
+        if (since >= VSYNC_MIN_US) {
+            if (since <= VSYNC_MAX_US &&
+                (!vsync_period_us || since < vsync_period_us + vsync_period_us / 2))
+                vsync_period_us = since;
+            vsync_last = now;
+            vsync_count++;
+            wake_up_interruptible_all(&vsync_wait);
+        }
+        if (vsync_period_us)
+            next_us = vsync_period_us - VSYNC_LEAD_US;
+    } else {
+        vsync_period_us = 0;
+    }
+
+    /* Woken ioctl callers have left; pollers stay queued while blocked */
+    if (!vsync_waiters && !waitqueue_active(&vsync_wait)) {
+        vsync_running = false;
+        spin_unlock(&vsync_lock);
+        return HRTIMER_NORESTART;
+    }
+    spin_unlock(&vsync_lock);
+
+    hrtimer_set_expires(timer, ktime_add_us(now, next_us));
+    return HRTIMER_RESTART;
+}
+
+/* Starts sampling for a caller about to block; vsync_lock held */
+static void vsync_start_locked(void)
+{
+    s64 since = ktime_us_delta(ktime_get(), vsync_last);
+    s64 delay_us = 0;
+
+    if (vsync_running)
+        return;
+    vsync_running = true;
+
+    if (vsync_period_us && since < vsync_period_us - VSYNC_LEAD_US)
+        delay_us = vsync_period_us - VSYNC_LEAD_US - since;
+    else if (since >= vsync_period_us + VSYNC_LEAD_US)
+        vsync_period_us = 0; /* a retrace went by unseen */
+    hrtimer_start(&vsync_timer, ns_to_ktime(delay_us * NSEC_PER_USEC), VSYNC_TIMER_MODE);
+}
+
+static void vsync_init(void)
+{
+    vga_status_port = phys_addr == 0xb0000 ? VGA_STATUS_MONO : VGA_STATUS_COLOR;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,13,0)
+    hrtimer_setup(&vsync_timer, vsync_tick, CLOCK_MONOTONIC, VSYNC_TIMER_MODE);
+#else
+    hrtimer_init(&vsync_timer, CLOCK_MONOTONIC, VSYNC_TIMER_MODE);
+    vsync_timer.function = vsync_tick;
+#endif
+}
+
+/* VRAM_IOC_WAIT_VSYNC: sleep until the next retrace starts */
+static long vram_wait_vsync(__u64 __user *ucount)
+{
+    unsigned long flags;
+    u64 seen, count;
+    long left;
+
+    if (!vsync)
+        return -EOPNOTSUPP;
+
+    spin_lock_irqsave(&vsync_lock, flags);
+    seen = vsync_count;
+    vsync_waiters++;
+    vsync_start_locked();
+    spin_unlock_irqrestore(&vsync_lock, flags);
+
+    left = wait_event_interruptible_timeout(vsync_wait,
+                                            vsync_read_count() != seen,
+                                            msecs_to_jiffies(VSYNC_TIMEOUT_MS));
+
+    spin_lock_irqsave(&vsync_lock, flags);
+    vsync_waiters--;
+    count = vsync_count;
+    spin_unlock_irqrestore(&vsync_lock, flags);
+
+    if (left < 0)
+        return left;
+    if (!left)
+        return -ETIMEDOUT; /* no retrace: not a VGA, or the display is off */
+    if (ucount && copy_to_user(ucount, &count, sizeof(count)))
+        return -EFAULT;
+    return 0;
+}
+
+static __poll_t vram_poll(struct file *file, poll_table *wait)
+{
+    struct vram_file *vf = file->private_data;
+    /* Replacing DEFAULT_POLLMASK: reads and writes never block */
+    __poll_t mask = EPOLLIN | EPOLLRDNORM | EPOLLOUT | EPOLLWRNORM;
+    unsigned long flags;
+
+    if (!vsync)
+        return mask;
+
+    poll_wait(file, &vsync_wait, wait);
+
+    /* Consumed under the lock, so threads sharing the file see it once */
+    spin_lock_irqsave(&vsync_lock, flags);
+    if (vsync_count != vf->vsync_seen) {
+        vf->vsync_seen = vsync_count;
+        mask |= EPOLLPRI;
+    } else {
+        vsync_start_locked();
+    }
+    spin_unlock_irqrestore(&vsync_lock, flags);
+    return mask;
+}
 
 static int vram_open(struct inode *inode, struct file *file)
 {
+    struct vram_file *vf = kzalloc(sizeof(*vf), GFP_KERNEL);
+
+    if (!vf)
+        return -ENOMEM;
+    vf->vsync_seen = vsync_read_count();
+    file->private_data = vf;
     return 0;
 }
 
 static int vram_release(struct inode *inode, struct file *file)
 {
+    kfree(file->private_data);
+    return 0;
+}
+
+static void vram_flush(struct work_struct *work)
+{
+    unsigned long pg;
+
+    for_each_set_bit(pg, dirty_pages, shadow_pages) {
+        unsigned long start = pg << PAGE_SHIFT;
+        struct page *page = vmalloc_to_page(shadow + start);
+
+        clear_bit(pg, dirty_pages);
+
+        /* Write-protect first: a store from here on faults and re-dirties */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,16,0)
+        folio_lock(page_folio(page));
+        folio_mkclean(page_folio(page));
+        folio_unlock(page_folio(page));
+#else
+        lock_page(page);
+        page_mkclean(page);
+        unlock_page(page);
+#endif
+
+        memcpy_toio(vram_base + start, shadow + start, min(PAGE_SIZE, vsize - start));
+    }
+}
+
+static void vram_mark_dirty(unsigned long start, unsigned long len)
+{
+    unsigned long pg;
+
+    for (pg = start >> PAGE_SHIFT; pg <= (start + len - 1) >> PAGE_SHIFT; pg++)
+        set_bit(pg, dirty_pages);
+    schedule_delayed_work(&flush_work, msecs_to_jiffies(defio_ms));
+}
+
+static vm_fault_t vram_defio_fault(struct vm_fault *vmf)
+{
+    unsigned long offset = vmf->pgoff << PAGE_SHIFT;
+    struct page *page;
+
+    if (offset >= vsize)
+        return VM_FAULT_SIGBUS;
+
+    page = vmalloc_to_page(shadow + offset);
+    get_page(page);
+    /* page_mkclean() finds the mappings through these */
+    page->mapping = vmf->vma->vm_file->f_mapping;
+    page->index = vmf->pgoff;
+
+    vmf->page = page;
+    return 0;
+}
+
+static vm_fault_t vram_defio_mkwrite(struct vm_fault *vmf)
+{
+    struct page *page = vmf->page;
+
+    /* Held locked until the PTE is writable, so a flush cannot slip between */
+    lock_page(page);
+    vram_mark_dirty(vmf->pgoff << PAGE_SHIFT, 1);
+    return VM_FAULT_LOCKED;
+}
+
+static const struct vm_operations_struct vram_defio_vm_ops = {
+    .fault = vram_defio_fault,
+    .page_mkwrite = vram_defio_mkwrite,
+};
+
+static int vram_defio_mmap(struct vm_area_struct *vma)
+{
+    vma->vm_ops = &vram_defio_vm_ops;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,3,0)
+    vm_flags_set(vma, VM_DONTEXPAND | VM_DONTDUMP);
+#else
+    vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+#endif
+    return 0;
+}
+
+static int vram_defio_init(void)
+{
+    shadow_pages = PAGE_ALIGN(vsize) >> PAGE_SHIFT;
+    shadow = vzalloc(shadow_pages << PAGE_SHIFT);
+    dirty_pages = bitmap_zalloc(shadow_pages, GFP_KERNEL);
+    if (!shadow || !dirty_pages) {
+        vfree(shadow);
+        bitmap_free(dirty_pages);
+        return -ENOMEM;
+    }
+
+    /* Start from what is on screen */
+    memcpy_fromio(shadow, vram_base, vsize);
+    INIT_DELAYED_WORK(&flush_work, vram_flush);
+    return 0;
+}
+
+static void vram_defio_cleanup(void)
+{
+    unsigned long pg;
+
+    /* Last writes still go out */
+    flush_delayed_work(&flush_work);
+    cancel_delayed_work_sync(&flush_work);
+
+    for (pg = 0; pg < shadow_pages; pg++)
+        vmalloc_to_page(shadow + (pg << PAGE_SHIFT))->mapping = NULL;
+    vfree(shadow);
+    bitmap_free(dirty_pages);
+}
+
+static int vram_fsync(struct file *file, loff_t start, loff_t end, int datasync)
+{
+    if (defio)
+        flush_delayed_work(&flush_work);
     return 0;
 }
 
@@ -50,12 +437,21 @@ static int vram_mmap(struct file *file, struct vm_area_struct *vma)
         return -EINVAL;
     }
 
-    /* Non-cached mapping for device memory is usually desirable */
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,17,0)
-    vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
-#else
-    vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
-#endif
+    if (defio)
+        return vram_defio_mmap(vma);
+
+    /*
+     * Uncached by default, so every store is its own bus cycle. With
+     * writecombine=1 the CPU merges stores into burst writes, which suits
+     * bulk screen updates; an O_SYNC open still gets an uncached mapping,
+     * as with /dev/mem. The parameter is read at mmap time, but the MTRR a
+     * non-PAT system needs is only added when it is set at load. See
+     * vram_wc_cookie for why the default 0xB8000 stays uncached anyway.
+     */
+    if (writecombine && !(file->f_flags & O_DSYNC))
+        vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+    else
+        vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
 
     pfn_start = phys_start >> PAGE_SHIFT;
 
@@ -67,20 +463,242 @@ static int vram_mmap(struct file *file, struct vm_area_struct *vma)
     return 0;
 }
 
+static loff_t vram_llseek(struct file *file, loff_t offset, int whence)
+{
+    return fixed_size_llseek(file, offset, whence, vsize);
+}
+
+static ssize_t vram_read(struct file *file, char __user *ubuf, size_t count, loff_t *ppos)
+{
+    loff_t pos = *ppos;
+    size_t done = 0;
+    void *buf;
+
+    if (pos < 0)
+        return -EINVAL;
+    if (pos >= vsize || !count)
+        return 0;
+    count = min_t(size_t, count, vsize - pos);
+
+    if (defio) {
+        done = count - copy_to_user(ubuf, shadow + pos, count);
+        if (!done)
+            return -EFAULT;
+        *ppos = pos + done;
+        return done;
+    }
+
+    buf = kmalloc(min_t(size_t, count, VRAM_CHUNK), GFP_KERNEL);
+    if (!buf)
+        return -ENOMEM;
+
+    while (done < count) {
+        size_t n = min_t(size_t, count - done, VRAM_CHUNK);
+
+        memcpy_fromio(buf, vram_base + pos + done, n);
+        if (copy_to_user(ubuf + done, buf, n))
+            break;
+        done += n;
+    }
+
+    kfree(buf);
+    if (!done)
+        return -EFAULT;
+    *ppos = pos + done;
+    return done;
+}
+
+/*
+ * Copies user data to VRAM through `bounce` (VRAM_CHUNK bytes), or to the
+ * shadow in defio mode, where `bounce` is unused. Returns the bytes copied.
+ */
+static size_t vram_store(unsigned long pos, const char __user *ubuf, size_t count, void *bounce)
+{
+    size_t done = 0;
+
+    if (defio) {
+        done = count - copy_from_user(shadow + pos, ubuf, count);
+        if (done)
+            vram_mark_dirty(pos, done);
+        return done;
+    }
+
+    while (done < count) {
+        size_t n = min_t(size_t, count - done, VRAM_CHUNK);
+
+        if (copy_from_user(bounce, ubuf + done, n))
+            break;
+        memcpy_toio(vram_base + pos + done, bounce, n);
+        done += n;
+    }
+    return done;
+}
+
+static ssize_t vram_write(struct file *file, const char __user *ubuf, size_t count, loff_t *ppos)
+{
+    loff_t pos = *ppos;
+    size_t done;
+    void *buf = NULL;
+
+    if (pos < 0)
+        return -EINVAL;
+    if (!count)
+        return 0;
+    if (pos >= vsize)
+        return -ENOSPC;
+    count = min_t(size_t, count, vsize - pos);
+
+    if (!defio) {
+        buf = kmalloc(min_t(size_t, count, VRAM_CHUNK), GFP_KERNEL);
+        if (!buf)
+            return -ENOMEM;
+    }
+
+    done = vram_store(pos, ubuf, count, buf);
+
+    kfree(buf);
+    if (!done)
+        return -EFAULT;
+    *ppos = pos + done;
+    return done;
+}
+
+/* VRAM_IOC_SCATTER: validate every segment, then store them in order */
+/* A batch may rewrite the region a few times over, not more */
+#define VRAM_SCATTER_MAX_PASSES 4
+
+static long vram_scatter(struct vram_scatter __user *uarg)
+{
+    struct vram_scatter req;
+    struct vram_segment *segs;
+    void *buf = NULL;
+    u64 total = 0;
+    long ret = 0;
+    u32 i;
+
+    if (copy_from_user(&req, uarg, sizeof(req)))
+        return -EFAULT;
+    if (req.reserved)
+        return -EINVAL;
+    if (!req.count)
+        return 0;
+    if (req.count > VRAM_MAX_SEGMENTS)
+        return -E2BIG;
+
+    segs = kvmalloc(req.count * sizeof(*segs), GFP_KERNEL);
+    if (!segs)
+        return -ENOMEM;
+    if (copy_from_user(segs, u64_to_user_ptr(req.segments), req.count * sizeof(*segs))) {
+        ret = -EFAULT;
+        goto out;
+    }
+
+    for (i = 0; i < req.count; i++) {
+        if ((u64)segs[i].offset + segs[i].length > vsize) {
+            ret = -EINVAL;
+            goto out;
+        }
+        total += segs[i].length;
+    }
+    if (total > (u64)vsize * VRAM_SCATTER_MAX_PASSES) {
+        ret = -E2BIG;
+        goto out;
+    }
+
+    if (!defio) {
+        buf = kmalloc(VRAM_CHUNK, GFP_KERNEL);
+        if (!buf) {
+            ret = -ENOMEM;
+            goto out;
+        }
+    }
+
+    /* Segments already stored stay applied if a later one fails */
+    for (i = 0; i < req.count; i++) {
+        if (fatal_signal_pending(current)) {
+            ret = -EINTR;
+            break;
+        }
+        if (vram_store(segs[i].offset, u64_to_user_ptr(segs[i].data),
+                       segs[i].length, buf) != segs[i].length) {
+            ret = -EFAULT;
+            break;
+        }
+        cond_resched();
+    }
+
+out:
+    kfree(buf);
+    kvfree(segs);
+    return ret;
+}
+
+static long vram_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    switch (cmd) {
+    case VRAM_IOC_SCATTER:
+        return vram_scatter((struct vram_scatter __user *)arg);
+    case VRAM_IOC_WAIT_VSYNC:
+        return vram_wait_vsync((__u64 __user *)arg);
+    default:
+        return -ENOTTY;
+    }
+}
+
 static const struct file_operations vram_fops = {
     .owner = THIS_MODULE,
     .open = vram_open,
     .release = vram_release,
+    .llseek = vram_llseek,
+    .read = vram_read,
+    .write = vram_write,
     .mmap = vram_mmap,
+    .fsync = vram_fsync,
+    .unlocked_ioctl = vram_ioctl,
+    .poll = vram_poll,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5,4,0)
+    .compat_ioctl = compat_ptr_ioctl,
+#endif
 };
 
 static int __init vram_init(void)
 {
     int ret;
 
+    vram_base = ioremap(phys_addr, vsize);
+    if (!vram_base) {
+        pr_err("vram: ioremap of 0x%lx failed\n", phys_addr);
+        return -ENOMEM;
+    }
+
+    if (writecombine) {
+        vram_wc_cookie = arch_phys_wc_add(phys_addr, vsize);
+        if (vram_wc_cookie < 0) {
+            pr_warn("vram: no WC MTRR for the region (%d), mappings may stay uncached\n",
+                    vram_wc_cookie);
+            vram_wc_cookie = 0;
+        }
+        if (phys_addr < VRAM_ISA_END)
+            pr_warn("vram: writecombine has no effect below 1 MiB, mappings stay uncached\n");
+    }
+
+    vsync_init();
+
+    if (defio) {
+        ret = vram_defio_init();
+        if (ret) {
+            pr_err("vram: shadow allocation failed\n");
+            vram_unmap();
+            return ret;
+        }
+    }
+
     ret = alloc_chrdev_region(&devt, 0, 1, "vram");
     if (ret) {
         pr_err("vram: alloc_chrdev_region failed: %d\n", ret);
+        if (defio)
+            vram_defio_cleanup();
+        vram_unmap();
         return ret;
     }
 
@@ -91,6 +709,9 @@ static int __init vram_init(void)
     if (ret) {
         pr_err("vram: cdev_add failed: %d\n", ret);
         unregister_chrdev_region(devt, 1);
+        if (defio)
+            vram_defio_cleanup();
+        vram_unmap();
         return ret;
     }
 
@@ -99,6 +720,9 @@ static int __init vram_init(void)
         pr_err("vram: class_create failed\n");
         cdev_del(&vram_cdev);
         unregister_chrdev_region(devt, 1);
+        if (defio)
+            vram_defio_cleanup();
+        vram_unmap();
         return PTR_ERR(vram_class);
     }
 
@@ -107,19 +731,27 @@ static int __init vram_init(void)
         class_destroy(vram_class);
         cdev_del(&vram_cdev);
         unregister_chrdev_region(devt, 1);
+        if (defio)
+            vram_defio_cleanup();
+        vram_unmap();
         return -ENOMEM;
     }
 
-    pr_info("vram: module loaded. /dev/vram created. phys=0x%lx size=0x%lx\n", phys_addr, vsize);
+    pr_info("vram: module loaded. /dev/vram created. phys=0x%lx size=0x%lx%s\n",
+            phys_addr, vsize, defio ? " defio" : writecombine ? " writecombine" : "");
     return 0;
 }
 
 static void __exit vram_exit(void)
 {
+    hrtimer_cancel(&vsync_timer);
     device_destroy(vram_class, devt);
     class_destroy(vram_class);
     cdev_del(&vram_cdev);
     unregister_chrdev_region(devt, 1);
+    if (defio)
+        vram_defio_cleanup();
+    vram_unmap();
     pr_info("vram: module unloaded\n");
 }
 